@@ -7,7 +7,7 @@
 #include "Lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
 
-bool FindKeyFromAdds(std::vector<std::shared_ptr<luabridge::LuaRef>> components, const std::string& key) {
+bool FindKeyFromAdds(std::vector<std::shared_ptr<Component>> components, const std::string& key) {
 	for (auto& component : components) {
 		if ((*component)["key"].cast<std::string>() == key) {
 			return true;
@@ -55,7 +55,7 @@ luabridge::LuaRef Actor::GetComponents(const std::string& type_name) {
 		for (auto& component : vec) {
 			auto& ref = *component;
 			if (!ref["removed"].cast<bool>()) {
-				componentTable[iter] = *component;
+				componentTable[iter] = component->Ref();
 				iter++;
 			}
 		}
@@ -71,11 +71,8 @@ luabridge::LuaRef Actor::AddComponent(const std::string& type_name) {
 	if (this->removed) return luabridge::LuaRef(ComponentDB::GetLuaState());
 	if (SceneDB::nowClearing && !this->dontDestroyOnLoad) return luabridge::LuaRef(ComponentDB::GetLuaState());
 	auto ref = ComponentDB::RuntimeComponentLoad(this, type_name);
-	if (std::find(SceneDB::compAddedActors.begin(), SceneDB::compAddedActors.end(), this)
-		== SceneDB::compAddedActors.end()) {
-		SceneDB::compAddedActors.push_back(this);
-		SceneDB::ActorInsertSort(SceneDB::compAddedActors);
-	}
+	this->componentsChanged = true;
+	SceneDB::compAddedActors.Insert(this);
 	return *ref;
 }
 
@@ -85,26 +82,19 @@ void Actor::RemoveComponent(luabridge::LuaRef component) {
 	if (this->keyedComponents.find(component["key"].cast<std::string>()) != this->keyedComponents.end()) {
 		component["enabled"] = false;
 		component["removed"] = true;
+		this->componentsChanged = true;
 		auto& ref = this->keyedComponents.at(component["key"].cast<std::string>());
 		if (!SceneDB::nowTrimming) {
 			if (std::find(this->removedComponents.begin(), this->removedComponents.end(), ref) == this->removedComponents.end()) {
 				this->removedComponents.push_back(ref);
 			}
-			if (std::find(SceneDB::compRemovedActors.begin(), SceneDB::compRemovedActors.end(), this)
-				== SceneDB::compRemovedActors.end()) {
-				SceneDB::compRemovedActors.push_back(this);
-				SceneDB::ActorInsertSort(SceneDB::compRemovedActors);
-			}
+			SceneDB::compRemovedActors.Insert(this);
 		}
 		else {
 			if (std::find(this->willRemoveComponents.begin(), this->willRemoveComponents.end(), ref) != this->willRemoveComponents.end()) {
 				this->willRemoveComponents.push_back(ref);
 			}
-			if (std::find(SceneDB::willCompRemoveActors.begin(), SceneDB::willCompRemoveActors.end(), this)
-				== SceneDB::willCompRemoveActors.end()) {
-				SceneDB::willCompRemoveActors.push_back(this);
-				SceneDB::ActorInsertSort(SceneDB::willCompRemoveActors);
-			}
+			SceneDB::willCompRemoveActors.Insert(this);
 		}
 	}
 	else if (FindKeyFromAdds(addedComponents, component["key"].cast<std::string>())) {
@@ -161,16 +151,20 @@ void Actor::SystemSave() {
 
 void Actor::LuaInit() {
 	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
-		.beginClass<Actor>("Actor")
-		.addFunction("GetName", &Actor::GetName)
-		.addFunction("GetID", &Actor::GetID)
-		.addFunction("GetComponentByKey", &Actor::GetComponentByKey)
-		.addFunction("GetComponent", &Actor::GetComponent)
-		.addFunction("GetComponents", &Actor::GetComponents)
-		.addFunction("AddComponent", &Actor::AddComponent)
-		.addFunction("RemoveComponent", &Actor::RemoveComponent)
-		.addFunction("DontSave", &Actor::DontSave)
-		.addFunction("SceneSave", &Actor::SceneSave)
-		.addFunction("SystemSave", &Actor::SystemSave)
+		.beginClass<ActorHandle>("Actor")
+		.addFunction("GetName", &ActorHandle::GetName)
+		.addFunction("GetID", &ActorHandle::GetID)
+		.addFunction("GetComponentByKey", &ActorHandle::GetComponentByKey)
+		.addFunction("GetComponent", &ActorHandle::GetComponent)
+		.addFunction("GetComponents", &ActorHandle::GetComponents)
+		.addFunction("AddComponent", &ActorHandle::AddComponent)
+		.addFunction("RemoveComponent", &ActorHandle::RemoveComponent)
+		.addFunction("DontSave", &ActorHandle::DontSave)
+		.addFunction("SceneSave", &ActorHandle::SceneSave)
+		.addFunction("SystemSave", &ActorHandle::SystemSave)
+		.addFunction("GetPosition", &ActorHandle::GetPosition)
+		.addFunction("SetPosition", &ActorHandle::SetPosition)
+		.addFunction("IsValid", &ActorHandle::IsValid)
+		.addFunction("__eq", &ActorHandle::Equals)
 		.endClass();
 }
\ No newline at end of file
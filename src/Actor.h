@@ -1,4 +1,8 @@
 #pragma once
+#include "ActorStore.h"
+#include "Component.h"
+
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -14,23 +18,36 @@ public:
 	bool dontDestroyOnLoad;
 	bool removed;
 	SAVE_TYPE save_type;
-	std::unordered_map<std::string, std::shared_ptr<luabridge::LuaRef>> keyedComponents;
-	std::unordered_map<std::string, std::vector<std::shared_ptr<luabridge::LuaRef>>> typedComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> startingComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> updatingComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> lateUpdatingComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> addedComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> removedComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> willRemoveComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> collisionEnterComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> collisionExitComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> triggerEnterComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> triggerExitComponents;
-	std::vector<std::shared_ptr<luabridge::LuaRef>> destroyingComponents;
+	bool registered = false; // Has entries in HookTable
+	uint64_t hookOrder = 0; // Scene epoch in the high bits, ID in the low bits
+	ActorHandle handle; // Stale until ActorStore::Insert
+	uint8_t queuedIn = 0; // ACTOR_QUEUE bits of the ActorSets this actor is in
+	std::string templateName; // Set when instantiated from a template at runtime
+	bool componentsChanged = false; // Added or removed a component since then, so ActorPool won't take it
+	bool hasPosition = false; // Set from Lua; SpatialIndex falls back on it when there is no Rigidbody
+	float positionX = 0.0f;
+	float positionY = 0.0f;
+	uint32_t spatialBucket = UINT32_MAX; // SpatialIndex bucket holding its entry; UINT32_MAX when it has none
+	uint32_t spatialSlot = 0; // Index of that entry in its bucket
+	bool spatialPending = false; // In SpatialIndex's list of actors to re-file before the next query
+	uint32_t viewFrame = 0; // Frame the view fields below were measured on, by UpdateScheduler
+	bool viewLocated = false; // Had a position to measure
+	bool viewOnScreen = false;
+	float viewDistance2 = 0.0f; // From the camera
+	std::unordered_map<std::string, std::shared_ptr<Component>> keyedComponents;
+	std::unordered_map<std::string, std::vector<std::shared_ptr<Component>>> typedComponents;
+	std::vector<std::shared_ptr<Component>> addedComponents;
+	std::vector<std::shared_ptr<Component>> removedComponents;
+	std::vector<std::shared_ptr<Component>> willRemoveComponents;
 
 	Actor() : actor_name(""), UUID(-1), dontDestroyOnLoad(false), removed(false), save_type(SAVE_NONE) {}
 
-	Actor(const Actor& templateActor) {
+	Actor(const Actor& templateActor) : Actor() {
+		ApplyTemplate(templateActor);
+	}
+
+	// Copies what a template decides about an actor, leaving its store slot and components alone.
+	void ApplyTemplate(const Actor& templateActor) {
 		actor_name = templateActor.actor_name;
 		UUID = templateActor.UUID;
 		dontDestroyOnLoad = templateActor.dontDestroyOnLoad;
@@ -40,17 +57,9 @@ public:
 	~Actor() {
 		keyedComponents.clear();
 		typedComponents.clear();
-		startingComponents.clear();
-		updatingComponents.clear();
-		lateUpdatingComponents.clear();
 		addedComponents.clear();
 		removedComponents.clear();
 		willRemoveComponents.clear();
-		collisionEnterComponents.clear();
-		collisionExitComponents.clear();
-		triggerEnterComponents.clear();
-		triggerExitComponents.clear();
-		destroyingComponents.clear();
 	}
 
 	std::string GetName() {
@@ -69,8 +78,8 @@ public:
 	luabridge::LuaRef GetComponentByKey(const std::string& key);
 	luabridge::LuaRef GetComponent(const std::string& type_name);
 	luabridge::LuaRef GetComponents(const std::string& type_name);
-	void InjectConvenienceReference(std::shared_ptr<luabridge::LuaRef>& component) {
-		(*component)["actor"] = this;
+	void InjectConvenienceReference(std::shared_ptr<Component>& component) {
+		(*component)["actor"] = handle;
 	}
 
 	luabridge::LuaRef AddComponent(const std::string& type_name);
@@ -0,0 +1,92 @@
+#include "Actor.h"
+#include "ActorPool.h"
+#include "ActorStore.h"
+#include "ComponentDB.h"
+#include "TemplateDB.h"
+
+#include <string>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+Actor* ActorPool::Build(const std::string& templateName) {
+	Actor* actor = new Actor();
+	TemplateDB::LoadTemplate(*actor, templateName);
+	actor->templateName = templateName;
+	return actor;
+}
+
+void ActorPool::Prewarm(const std::string& templateName, int count) {
+	Pool& pool = ActorPool::pools[templateName];
+	pool.spares.reserve(count);
+	while (static_cast<int>(pool.spares.size()) < count) {
+		pool.spares.push_back(ActorPool::Build(templateName));
+	}
+}
+
+Actor* ActorPool::Acquire(const std::string& templateName) {
+	auto it = ActorPool::pools.find(templateName);
+	if (it == ActorPool::pools.end() || it->second.spares.empty()) {
+		if (it != ActorPool::pools.end()) {
+			it->second.misses++;
+		}
+		// Takes a slot first so the components built from the template capture a live handle.
+		Actor* actor = new Actor();
+		ActorStore::Insert(actor);
+		TemplateDB::LoadTemplate(*actor, templateName);
+		actor->templateName = templateName;
+		return actor;
+	}
+
+	Pool& pool = it->second;
+	pool.hits++;
+	Actor* actor = pool.spares.back();
+	pool.spares.pop_back();
+
+	// A recycled component may still have tombstoned entries if it died since the last Compact, maybe
+	// under a loop dispatching them right now. Its attachment moved on when it was detached, so those
+	// entries stay dead once it is re-registered, and the end-of-frame Compact clears them.
+	ActorStore::Insert(actor);
+	for (auto& component : actor->keyedComponents) {
+		component.second->detached = false;
+		component.second->onScreen = false;
+		if (!(*component.second).isUserdata()) {
+			actor->InjectConvenienceReference(component.second);
+		}
+	}
+	return actor;
+}
+
+bool ActorPool::Release(Actor* actor) {
+	if (actor->templateName.empty() || actor->componentsChanged || actor->save_type != SAVE_NONE) {
+		return false;
+	}
+	auto it = ActorPool::pools.find(actor->templateName);
+	if (it == ActorPool::pools.end()) {
+		return false;
+	}
+
+	TemplateDB::ResetToTemplate(*actor, actor->templateName);
+	actor->removed = false;
+	actor->queuedIn = 0;
+	actor->hasPosition = false;
+	it->second.spares.push_back(actor);
+	return true;
+}
+
+luabridge::LuaRef ActorPool::GetStats(const std::string& templateName) {
+	luabridge::LuaRef stats = luabridge::newTable(ComponentDB::GetLuaState());
+	auto it = ActorPool::pools.find(templateName);
+	if (it != ActorPool::pools.end()) {
+		stats["hits"] = static_cast<double>(it->second.hits);
+		stats["misses"] = static_cast<double>(it->second.misses);
+		stats["spares"] = static_cast<int>(it->second.spares.size());
+	}
+	else {
+		stats["hits"] = 0;
+		stats["misses"] = 0;
+		stats["spares"] = 0;
+	}
+	return stats;
+}
\ No newline at end of file
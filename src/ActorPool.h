@@ -0,0 +1,32 @@
+#pragma once
+#include "Actor.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+/* Spare actors per template, so a template that spawns and dies constantly stops building and freeing
+   Lua tables every time. Opt-in: only templates named in Actor.Prewarm are pooled. A destroyed actor
+   goes back to its pool if it still has exactly its template's components; its script tables are
+   wiped and its Rigidbody/ParticleSystem reset rather than rebuilt. A script that kept a reference
+   to one of those tables after the actor died will see it reused. */
+class ActorPool {
+public:
+	static void Prewarm(const std::string& templateName, int count); // Tops the pool up to count spares
+	static Actor* Acquire(const std::string& templateName); // Inserted in the store, not yet registered
+	static bool Release(Actor* actor); // Call after UnregisterActor and Erase; false means delete it
+	static luabridge::LuaRef GetStats(const std::string& templateName);
+private:
+	struct Pool {
+		std::vector<Actor*> spares;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+	};
+	static inline std::unordered_map<std::string, Pool> pools;
+	static Actor* Build(const std::string& templateName);
+	ActorPool() {}
+};
\ No newline at end of file
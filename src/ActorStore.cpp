@@ -0,0 +1,187 @@
+#include "Actor.h"
+#include "ActorStore.h"
+#include "ComponentDB.h"
+#include "Rigidbody.h"
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+bool DispatchBefore(const Actor* a, const Actor* b) {
+	return a->hookOrder < b->hookOrder;
+}
+
+std::string ActorHandle::GetName() const {
+	Actor* actor = Get();
+	return actor != nullptr ? actor->GetName() : "";
+}
+
+int ActorHandle::GetID() const {
+	Actor* actor = Get();
+	return actor != nullptr ? actor->GetID() : -1;
+}
+
+luabridge::LuaRef ActorHandle::GetComponentByKey(const std::string& key) const {
+	Actor* actor = Get();
+	return actor != nullptr ? actor->GetComponentByKey(key) : luabridge::LuaRef(ComponentDB::GetLuaState());
+}
+
+luabridge::LuaRef ActorHandle::GetComponent(const std::string& type_name) const {
+	Actor* actor = Get();
+	return actor != nullptr ? actor->GetComponent(type_name) : luabridge::LuaRef(ComponentDB::GetLuaState());
+}
+
+luabridge::LuaRef ActorHandle::GetComponents(const std::string& type_name) const {
+	Actor* actor = Get();
+	return actor != nullptr ? actor->GetComponents(type_name) : luabridge::newTable(ComponentDB::GetLuaState());
+}
+
+luabridge::LuaRef ActorHandle::AddComponent(const std::string& type_name) const {
+	Actor* actor = Get();
+	return actor != nullptr ? actor->AddComponent(type_name) : luabridge::LuaRef(ComponentDB::GetLuaState());
+}
+
+void ActorHandle::RemoveComponent(luabridge::LuaRef component) const {
+	if (Actor* actor = Get()) {
+		actor->RemoveComponent(component);
+	}
+}
+
+void ActorHandle::DontSave() const {
+	if (Actor* actor = Get()) {
+		actor->DontSave();
+	}
+}
+
+void ActorHandle::SceneSave() const {
+	if (Actor* actor = Get()) {
+		actor->SceneSave();
+	}
+}
+
+void ActorHandle::SystemSave() const {
+	if (Actor* actor = Get()) {
+		actor->SystemSave();
+	}
+}
+
+b2Vec2 ActorHandle::GetPosition() const {
+	b2Vec2 position(0.0f, 0.0f);
+	if (Actor* actor = Get()) {
+		SpatialIndex::PositionOf(actor, position);
+	}
+	return position;
+}
+
+void ActorHandle::SetPosition(const b2Vec2& position) const {
+	Actor* actor = Get();
+	if (actor == nullptr) {
+		return;
+	}
+	auto it = actor->typedComponents.find("Rigidbody");
+	if (it != actor->typedComponents.end() && !it->second.empty()) {
+		(*it->second.front()).cast<Rigidbody*>()->SetPosition(position);
+		return;
+	}
+	actor->hasPosition = true;
+	actor->positionX = position.x;
+	actor->positionY = position.y;
+	SpatialIndex::Touch(actor);
+}
+
+void ActorStore::Insert(Actor* actor) {
+	uint32_t slot_index;
+	if (!ActorStore::freeSlots.empty()) {
+		slot_index = ActorStore::freeSlots.back();
+		ActorStore::freeSlots.pop_back();
+	}
+	else {
+		slot_index = static_cast<uint32_t>(ActorStore::slots.size());
+		ActorStore::slots.emplace_back();
+	}
+
+	Slot& slot = ActorStore::slots[slot_index];
+	slot.actor = actor;
+	slot.denseIndex = static_cast<uint32_t>(ActorStore::dense.size());
+	ActorStore::dense.push_back(actor);
+	actor->handle = { slot_index, slot.generation };
+	SpatialIndex::Touch(actor);
+}
+
+void ActorStore::Erase(Actor* actor) {
+	if (ActorStore::Resolve(actor->handle) != actor) {
+		return;
+	}
+	SpatialIndex::Remove(actor);
+
+	Slot& slot = ActorStore::slots[actor->handle.slot];
+	Actor* moved = ActorStore::dense.back();
+	ActorStore::dense[slot.denseIndex] = moved;
+	ActorStore::slots[moved->handle.slot].denseIndex = slot.denseIndex;
+	ActorStore::dense.pop_back();
+
+	slot.actor = nullptr;
+	slot.generation++;
+	if (slot.generation == 0) {
+		slot.generation = 1;
+	}
+	ActorStore::freeSlots.push_back(actor->handle.slot);
+	actor->handle = ActorHandle();
+}
+
+void ActorStore::Reserve(size_t count) {
+	ActorStore::dense.reserve(ActorStore::dense.size() + count);
+	if (count > ActorStore::freeSlots.size()) {
+		ActorStore::slots.reserve(ActorStore::slots.size() + count - ActorStore::freeSlots.size());
+	}
+}
+
+std::vector<Actor*> ActorStore::LiveInOrder() {
+	std::vector<Actor*> ordered = ActorStore::dense;
+	std::sort(ordered.begin(), ordered.end(), &DispatchBefore);
+	return ordered;
+}
+
+luabridge::LuaRef ActorStore::ToLua(Actor* actor) {
+	if (actor == nullptr) {
+		return luabridge::LuaRef(ComponentDB::GetLuaState());
+	}
+	return luabridge::LuaRef(ComponentDB::GetLuaState(), actor->handle);
+}
+
+void ActorSet::Insert(Actor* actor) {
+	if (actor->queuedIn & this->queue) {
+		return;
+	}
+	actor->queuedIn |= this->queue;
+	if (!this->members.empty() && actor->hookOrder < this->lastOrder) {
+		this->ordered = false;
+	}
+	this->lastOrder = actor->hookOrder;
+	this->members.push_back(actor->handle);
+}
+
+std::vector<Actor*> ActorSet::Take() {
+	std::vector<Actor*> actors;
+	actors.reserve(this->members.size());
+	for (auto& handle : this->members) {
+		if (Actor* actor = handle.Get()) {
+			actor->queuedIn &= ~this->queue;
+			actors.push_back(actor);
+		}
+	}
+	if (!this->ordered) {
+		std::sort(actors.begin(), actors.end(), &DispatchBefore);
+	}
+	this->members.clear();
+	this->ordered = true;
+	return actors;
+}
+
+void ActorSet::Clear() {
+	this->Take();
+}
\ No newline at end of file
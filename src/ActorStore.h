@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "box2d/box2d.h"
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+class Actor;
+
+/* What Lua holds instead of an Actor*. Erasing an actor bumps its slot's generation, so a handle that
+   outlives the actor stops resolving instead of dangling. On a stale handle the getters return
+   nil, "" or -1 and everything else does nothing; IsValid lets a script check first. */
+struct ActorHandle {
+	uint32_t slot = 0;
+	uint32_t generation = 0; // Live slots never have generation 0, so a default handle is always stale
+
+	Actor* Get() const;
+	bool IsValid() const {
+		return Get() != nullptr;
+	}
+	bool Equals(const ActorHandle& other) const {
+		return slot == other.slot && generation == other.generation;
+	}
+
+	std::string GetName() const;
+	int GetID() const;
+	luabridge::LuaRef GetComponentByKey(const std::string& key) const;
+	luabridge::LuaRef GetComponent(const std::string& type_name) const;
+	luabridge::LuaRef GetComponents(const std::string& type_name) const;
+	luabridge::LuaRef AddComponent(const std::string& type_name) const;
+	void RemoveComponent(luabridge::LuaRef component) const;
+	void DontSave() const;
+	void SceneSave() const;
+	void SystemSave() const;
+	b2Vec2 GetPosition() const;
+	void SetPosition(const b2Vec2& position) const;
+};
+
+/* Every live actor, in a generational slot map. Insert and Erase are O(1); Erase swaps the last
+   actor into the hole, so Live() is in no particular order. */
+class ActorStore {
+public:
+	static void Insert(Actor* actor);
+	static void Erase(Actor* actor);
+	static void Reserve(size_t count);
+	static Actor* Resolve(const ActorHandle& handle) {
+		if (handle.slot >= ActorStore::slots.size()) {
+			return nullptr;
+		}
+		const Slot& slot = ActorStore::slots[handle.slot];
+		return slot.generation == handle.generation ? slot.actor : nullptr;
+	}
+	static const std::vector<Actor*>& Live() {
+		return ActorStore::dense;
+	}
+	static std::vector<Actor*> LiveInOrder(); // Dispatch order: scene epoch, then ID
+	static luabridge::LuaRef ToLua(Actor* actor); // nil for nullptr
+private:
+	struct Slot {
+		Actor* actor = nullptr;
+		uint32_t generation = 1;
+		uint32_t denseIndex = 0;
+	};
+	static inline std::vector<Slot> slots;
+	static inline std::vector<uint32_t> freeSlots;
+	static inline std::vector<Actor*> dense;
+	ActorStore() {}
+};
+
+inline Actor* ActorHandle::Get() const {
+	return ActorStore::Resolve(*this);
+}
+
+enum ACTOR_QUEUE : uint8_t { QUEUE_COMPONENT_ADD = 1, QUEUE_COMPONENT_REMOVE = 2, QUEUE_COMPONENT_REMOVE_NEXT = 4 };
+
+/* Actors waiting on one phase, each at most once. Membership is a bit on the actor, so Insert is O(1),
+   and Take hands back the ones still alive in dispatch order. */
+class ActorSet {
+public:
+	explicit ActorSet(ACTOR_QUEUE queue) : queue(queue) {}
+	void Insert(Actor* actor);
+	std::vector<Actor*> Take();
+	void Clear();
+	bool Empty() const {
+		return members.empty();
+	}
+private:
+	ACTOR_QUEUE queue;
+	std::vector<ActorHandle> members;
+	uint64_t lastOrder = 0;
+	bool ordered = true; // Still sorted; true as long as members arrive in order
+};
\ No newline at end of file
@@ -12,6 +12,16 @@
 #include "LuaBridge/LuaBridge.h"
 #include "SDL2_Mix/SDL_mixer.h"
 
+void AudioDB::Adopt(const std::string& clip_name, Mix_Chunk* chunk) {
+	auto it = AudioDB::sound_chunks.find(clip_name);
+	if (it == AudioDB::sound_chunks.end() || it->second == nullptr) {
+		AudioDB::sound_chunks[clip_name] = chunk;
+	}
+	else if (it->second != chunk) {
+		Mix_FreeChunk(chunk); // Play got to it first
+	}
+}
+
 void Play(int channel, const std::string& clip_name, bool does_loop) {
 	Mix_Chunk* audio_chunk = nullptr;
 	try {
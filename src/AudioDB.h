@@ -8,6 +8,7 @@ class AudioDB {
 public:
 	static inline std::unordered_map<std::string, Mix_Chunk*> sound_chunks;
 
+	static void Adopt(const std::string& clip_name, Mix_Chunk* chunk); // Decoded elsewhere
 	static void LuaInit();
 private:
 	AudioDB() {}
@@ -0,0 +1,150 @@
+#include "BatchDispatch.h"
+#include "ComponentDB.h"
+#include "Profiler.h"
+#include "UpdateScheduler.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+// Runs instances[first..last] inside Lua, so a whole run costs one C++ -> Lua transition.
+// There is deliberately no pcall per instance: the loop records how far it got, and on an
+// error RunLoop reports it against that instance and re-enters just past it.
+const char* BATCH_LOOP_SOURCE =
+"local cursor = 0\n"
+"local function run(instances, hooks, first, last)\n"
+"	for i = first, last do\n"
+"		cursor = i\n"
+"		local instance = instances[i]\n"
+"		if instance.enabled then\n"
+"			hooks[i](instance)\n"
+"		end\n"
+"	end\n"
+"end\n"
+"return run, function() return cursor end\n";
+
+BatchLoop BatchDispatch::CompileLoop(lua_State* L) {
+	if (luaL_loadstring(L, BATCH_LOOP_SOURCE) != LUA_OK) {
+		std::string error_message = lua_tostring(L, -1);
+		lua_pop(L, 1);
+		throw std::runtime_error("failed to compile batch dispatch loop: " + error_message);
+	}
+	lua_call(L, 0, 2);
+	luabridge::LuaRef cursor = luabridge::LuaRef::fromStack(L);
+	luabridge::LuaRef run = luabridge::LuaRef::fromStack(L);
+	return BatchLoop{ run, cursor };
+}
+
+void BatchDispatch::RunLoop(lua_State* L, const BatchLoop& loop, const DispatchBatch& batch, int first, int last) {
+	while (first <= last) {
+		loop.run.push(L);
+		batch.instances->push(L);
+		batch.hooks->push(L);
+		lua_pushinteger(L, first);
+		lua_pushinteger(L, last);
+		if (lua_pcall(L, 4, 0, 0) == LUA_OK) {
+			return;
+		}
+
+		const char* message = lua_tostring(L, -1);
+		std::string error_message = message != nullptr ? message : "(error object is not a string)";
+		lua_pop(L, 1);
+
+		loop.cursor.push(L);
+		lua_call(L, 0, 1);
+		int failed = static_cast<int>(lua_tointeger(L, -1));
+		lua_pop(L, 1);
+
+		std::string actor_name = "";
+		if (failed >= 1 && failed <= static_cast<int>(batch.actors.size())) {
+			actor_name = batch.actors[failed - 1]->GetName();
+		}
+		ComponentDB::ReportError(actor_name, error_message);
+		first = std::max(failed, first) + 1;
+	}
+}
+
+void BatchDispatch::Dispatch(DispatchPhase& phase, const HookRange& entries) {
+	// Membership only changes through HookTable, which bumps its generation when it does, so a quiet
+	// frame neither walks the entries nor touches Lua before running the batches.
+	if (!phase.built || phase.generation != HookTable::Generation()) {
+		BatchDispatch::Rebuild(phase, entries);
+		phase.generation = HookTable::Generation();
+		phase.built = true;
+	}
+
+	if (!BatchDispatch::loop) {
+		BatchDispatch::loop = BatchDispatch::CompileLoop(ComponentDB::GetLuaState());
+	}
+
+	for (auto& run : phase.runs) {
+		ProfileScope scope(phase.scopeName);
+		if (Profiler::enabled) {
+			scope.Tag(run.batch->actors[run.first - 1]->GetName(), run.batch->type);
+		}
+		if (run.batch->gated) {
+			BatchDispatch::RunDue(run);
+		}
+		else {
+			BatchDispatch::RunLoop(ComponentDB::GetLuaState(), *BatchDispatch::loop, *run.batch, run.first, run.last);
+		}
+	}
+}
+
+void BatchDispatch::RunDue(const DispatchRun& run) {
+	// Membership stays whole so the Lua arrays are not rebuilt as staggered instances come and go;
+	// instead the run is cut into the stretches that are due this frame.
+	const DispatchBatch& batch = *run.batch;
+	int first = run.first;
+	while (first <= run.last) {
+		while (first <= run.last && !UpdateScheduler::IsDue(batch.actors[first - 1], *batch.components[first - 1])) {
+			first++;
+		}
+		int last = first;
+		while (last + 1 <= run.last && UpdateScheduler::IsDue(batch.actors[last], *batch.components[last])) {
+			last++;
+		}
+		if (first <= run.last) {
+			BatchDispatch::RunLoop(ComponentDB::GetLuaState(), *BatchDispatch::loop, batch, first, last);
+		}
+		first = last + 1;
+	}
+}
+
+void BatchDispatch::Rebuild(DispatchPhase& phase, const HookRange& entries) {
+	lua_State* L = ComponentDB::GetLuaState();
+	phase.batches.clear();
+	phase.runs.clear();
+
+	// The entries keep their components alive until the Compact that follows their removal, and that
+	// removal bumps the generation, so the raw pointers below never outlive a rebuild.
+	for (auto& entry : entries) {
+		Component* component = entry.component.get();
+		const std::string& type = component->TypeName();
+
+		auto& batch = phase.batches[type];
+		if (!batch.instances) {
+			batch.type = type;
+			batch.instances = luabridge::newTable(L);
+			batch.hooks = luabridge::newTable(L);
+		}
+		batch.count++;
+		(*batch.instances)[batch.count] = component->Ref();
+		(*batch.hooks)[batch.count] = component->Hook(phase.hook);
+		batch.actors.push_back(entry.actor);
+		batch.components.push_back(component);
+		batch.gated = batch.gated || component->policy.Gated();
+
+		// Execution order is actor ID then key across all types, so a run only extends while the
+		// type stays the same. A scene full of one bullet type collapses into a single call.
+		if (!phase.runs.empty() && phase.runs.back().batch == &batch && phase.runs.back().last == batch.count - 1) {
+			phase.runs.back().last = batch.count;
+		}
+		else {
+			phase.runs.push_back({ &batch, batch.count, batch.count });
+		}
+	}
+}
\ No newline at end of file
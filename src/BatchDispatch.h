@@ -0,0 +1,65 @@
+#pragma once
+#include "Actor.h"
+#include "Component.h"
+#include "HookTable.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+/* Lua-side arrays of one component type's instances (and their hooks) for one phase. */
+struct DispatchBatch {
+	std::string type;
+	std::optional<luabridge::LuaRef> instances;
+	std::optional<luabridge::LuaRef> hooks;
+	std::vector<Actor*> actors; // actors[i - 1] owns instances[i], for error reports
+	std::vector<Component*> components; // components[i - 1] is instances[i], for its UpdatePolicy
+	bool gated = false; // Some instance has an UpdatePolicy that can skip it
+	int count = 0;
+};
+
+/* Consecutive components of one type in execution order, dispatched with a single call. */
+struct DispatchRun {
+	DispatchBatch* batch = nullptr;
+	int first = 1;
+	int last = 0;
+};
+
+/* The generated Lua loop and a getter for the index it last reached. */
+struct BatchLoop {
+	luabridge::LuaRef run;
+	luabridge::LuaRef cursor;
+};
+
+struct DispatchPhase {
+	HOOK_TYPE hook = HOOK_UPDATE;
+	const char* scopeName = "";
+	uint64_t generation = 0; // HookTable::Generation() the batches were built at
+	bool built = false;
+	std::unordered_map<std::string, DispatchBatch> batches;
+	std::vector<DispatchRun> runs;
+
+	DispatchPhase(HOOK_TYPE hook, const char* scopeName) : hook(hook), scopeName(scopeName) {}
+};
+
+class BatchDispatch {
+public:
+	static inline bool enabled = false;
+	static inline DispatchPhase update = DispatchPhase(HOOK_UPDATE, "OnUpdateBatch");
+	static inline DispatchPhase lateUpdate = DispatchPhase(HOOK_LATE_UPDATE, "OnLateUpdateBatch");
+
+	static void Dispatch(DispatchPhase& phase, const HookRange& entries);
+	static BatchLoop CompileLoop(lua_State* L);
+	static void RunLoop(lua_State* L, const BatchLoop& loop, const DispatchBatch& batch, int first, int last);
+private:
+	static inline std::optional<BatchLoop> loop;
+
+	static void Rebuild(DispatchPhase& phase, const HookRange& entries);
+	static void RunDue(const DispatchRun& run);
+	BatchDispatch() {}
+};
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "BatchDispatch.h"
+#include "Benchmark.h"
+#include "LuaAllocator.h"
+#include "LuaHeap.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "SDL2/SDL.h"
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#include <psapi.h>
+#elif __APPLE__
+	#include <mach/mach.h>
+#else
+	#include <fstream>
+	#include <unistd.h>
+#endif
+
+double Percentile(const std::vector<double>& sorted, double percent) {
+	if (sorted.empty()) {
+		return 0.0;
+	}
+	size_t rank = static_cast<size_t>(percent / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+double Mean(const std::vector<double>& values) {
+	if (values.empty()) {
+		return 0.0;
+	}
+	double sum = 0.0;
+	for (double value : values) {
+		sum += value;
+	}
+	return sum / values.size();
+}
+
+void Benchmark::ParseArgs(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--headless") {
+			Benchmark::headless = true;
+		}
+		else if (arg == "--bench-dispatch") {
+			Benchmark::dispatchBench = true;
+		}
+		else if (arg == "--bench-alloc") {
+			Benchmark::allocBench = true;
+		}
+		else if (arg == "--lua-alloc" && i + 1 < argc) {
+			std::string name = argv[++i];
+			if (LuaAllocator::ParseKind(name)) {
+				Benchmark::allocatorChosen = true;
+			}
+			else {
+				std::cout << "warning: --lua-alloc must be pooled or system, not " << name << std::endl;
+			}
+		}
+		else if (arg == "--frames" && i + 1 < argc) {
+			Benchmark::frameLimit = std::max(std::atoi(argv[++i]), 0);
+		}
+		else {
+			std::cout << "warning: unrecognized argument " << arg << std::endl;
+		}
+	}
+}
+
+void Benchmark::ConfigureHeadlessDrivers() {
+	// Must run before SDL_Init / Mix_OpenAudio so the dummy backends are picked up.
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	Profiler::collectStats = true;
+}
+
+void Benchmark::BeginFrame() {
+	Benchmark::frameStart = Profiler::Now();
+}
+
+bool Benchmark::EndFrame() {
+	double frame_ms = (Profiler::Now() - Benchmark::frameStart) / 1.0e6;
+	size_t frame_index = Benchmark::frameTimes.size();
+	Benchmark::frameTimes.push_back(frame_ms);
+	Benchmark::heapSizes.push_back(LuaHeap::lastHeapKB);
+	Benchmark::gcStepTimes.push_back(LuaHeap::lastStepMs);
+	Benchmark::allocCounts.push_back(static_cast<double>(LuaAllocator::lastFrame.allocations));
+	Benchmark::peakLiveBytes = std::max(Benchmark::peakLiveBytes, LuaAllocator::lastFrame.peakBytes);
+
+	for (auto& total : Profiler::TakeThreadTotals()) {
+		auto& samples = Benchmark::phaseTimes[total.first];
+		samples.resize(frame_index, 0.0); // Phases first seen mid-run took no time before
+		samples.push_back(total.second / 1.0e6);
+	}
+
+	return Benchmark::frameLimit == 0 || static_cast<int>(Benchmark::frameTimes.size()) < Benchmark::frameLimit;
+}
+
+void Benchmark::Report() {
+	if (Benchmark::frameTimes.empty()) {
+		std::cout << "benchmark: no frames ran" << std::endl;
+		return;
+	}
+
+	std::vector<double> sorted = Benchmark::frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	double mean = Mean(sorted);
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "benchmark: " << sorted.size() << " frames (ms)" << std::endl;
+	std::cout << "  frame  min " << sorted.front() << "  mean " << mean
+		<< "  p50 " << Percentile(sorted, 50.0) << "  p99 " << Percentile(sorted, 99.0)
+		<< "  max " << sorted.back() << std::endl;
+
+	std::vector<double> heap = Benchmark::heapSizes;
+	std::sort(heap.begin(), heap.end());
+	std::vector<double> gc_steps = Benchmark::gcStepTimes;
+	std::sort(gc_steps.begin(), gc_steps.end());
+	std::cout << "  lua heap (KB)  mean " << Mean(heap) << "  p50 " << Percentile(heap, 50.0)
+		<< "  max " << heap.back() << "  gc step (ms) p99 " << Percentile(gc_steps, 99.0)
+		<< "  max " << gc_steps.back() << std::endl;
+
+	std::vector<double> allocs = Benchmark::allocCounts;
+	std::sort(allocs.begin(), allocs.end());
+	std::cout << "  lua allocs/frame (" << LuaAllocator::KindName(LuaAllocator::kind) << ")  mean " << Mean(allocs)
+		<< "  p50 " << Percentile(allocs, 50.0) << "  max " << allocs.back()
+		<< "  peak live KB " << Benchmark::peakLiveBytes / 1024 << "  resident KB " << Benchmark::ResidentKB() << std::endl;
+
+	std::vector<std::pair<std::string, std::vector<double>>> phases(
+		Benchmark::phaseTimes.begin(), Benchmark::phaseTimes.end());
+	for (auto& phase : phases) {
+		phase.second.resize(sorted.size(), 0.0);
+		std::sort(phase.second.begin(), phase.second.end());
+	}
+	std::sort(phases.begin(), phases.end(), [](const auto& a, const auto& b) {
+		return Mean(a.second) > Mean(b.second);
+	});
+
+	std::cout << "  per-phase (inclusive; hook rows are summed over all components):" << std::endl;
+	for (auto& phase : phases) {
+		double phase_mean = Mean(phase.second);
+		std::cout << "  " << std::left << std::setw(20) << phase.first << std::right
+			<< "  mean " << phase_mean << "  p50 " << Percentile(phase.second, 50.0)
+			<< "  p99 " << Percentile(phase.second, 99.0) << "  max " << phase.second.back()
+			<< "  (" << std::setprecision(1) << (mean > 0.0 ? 100.0 * phase_mean / mean : 0.0) << "%)"
+			<< std::setprecision(3) << std::endl;
+	}
+}
+
+// Best of a few repetitions, in ns per component per frame, starting each from a collected heap.
+double TimeDispatch(lua_State* L, int frames, int count, const std::function<void()>& frame_body) {
+	double best = 0.0;
+	for (int repetition = 0; repetition < 5; repetition++) {
+		lua_gc(L, LUA_GCCOLLECT, 0);
+		uint64_t start = Profiler::Now();
+		for (int frame = 0; frame < frames; frame++) {
+			frame_body();
+		}
+		double elapsed = static_cast<double>(Profiler::Now() - start) / (static_cast<double>(frames) * count);
+		if (repetition == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+void Benchmark::RunDispatchBenchmark() {
+	const int frames = Benchmark::frameLimit > 0 ? Benchmark::frameLimit : 60;
+	lua_State* L = luaL_newstate();
+	luaL_openlibs(L);
+	luaL_dostring(L, "Spinner = { OnUpdate = function(self) end }");
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "dispatch benchmark: OnUpdate cost in ns per component per frame (" << frames << " frames)" << std::endl;
+	std::cout << "  components    per-call     batched    speedup" << std::endl;
+	{
+		luabridge::LuaRef type = luabridge::getGlobal(L, "Spinner");
+		luabridge::LuaRef hook = type["OnUpdate"];
+		luabridge::LuaRef metatable = luabridge::newTable(L);
+		metatable["__index"] = type;
+		BatchLoop loop = BatchDispatch::CompileLoop(L);
+
+		for (int count : { 16, 256, 4096, 65536 }) {
+			DispatchBatch batch;
+			batch.type = "Spinner";
+			batch.instances = luabridge::newTable(L);
+			batch.hooks = luabridge::newTable(L);
+			std::vector<luabridge::LuaRef> instances;
+			for (int i = 1; i <= count; i++) {
+				luabridge::LuaRef instance = luabridge::newTable(L);
+				instance["ticks"] = 0;
+				instance["enabled"] = true;
+				instance.push(L);
+				metatable.push(L);
+				lua_setmetatable(L, -2);
+				lua_pop(L, 1);
+				(*batch.instances)[i] = instance;
+				(*batch.hooks)[i] = hook;
+				instances.push_back(instance);
+			}
+			batch.count = count;
+
+			// Same shape as the unbatched Engine::OnUpdate loop: one LuaBridge call per component.
+			auto per_call_frame = [&]() {
+				for (auto& instance : instances) {
+					try {
+						hook(instance);
+					}
+					catch (const luabridge::LuaException& e) {
+						std::cout << e.what() << std::endl;
+					}
+				}
+			};
+			auto batched_frame = [&]() {
+				BatchDispatch::RunLoop(L, loop, batch, 1, count);
+			};
+			double per_call = TimeDispatch(L, frames, count, per_call_frame);
+			double batched = TimeDispatch(L, frames, count, batched_frame);
+
+			std::cout << "  " << std::setw(10) << count << "  " << std::setw(10) << per_call
+				<< "  " << std::setw(10) << batched << "  " << std::setw(8)
+				<< (batched > 0.0 ? per_call / batched : 0.0) << "x" << std::endl;
+		}
+	}
+	lua_close(L);
+}
+
+size_t Benchmark::ResidentKB() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.WorkingSetSize / 1024;
+#elif __APPLE__
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+		return 0;
+	}
+	return info.resident_size / 1024;
+#else
+	std::ifstream statm("/proc/self/statm");
+	size_t total_pages = 0;
+	size_t resident_pages = 0;
+	if (!(statm >> total_pages >> resident_pages)) {
+		return 0;
+	}
+	return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+#endif
+}
+
+struct AllocatorRun {
+	std::vector<double> frameTimes;
+	std::vector<double> allocCounts;
+	size_t peakLiveBytes = 0;
+	size_t residentGrowthKB = 0;
+};
+
+// A scene's worth of component instances sharing one metatable, as ComponentDB builds them,
+// whose OnUpdate makes the per-call garbage typical scripts make: a temporary table and a fresh string.
+AllocatorRun RunAllocatorScene(LUA_ALLOCATOR allocator_kind, int actor_count, int frames) {
+	AllocatorRun run;
+	size_t resident_before = Benchmark::ResidentKB();
+	LuaAllocStats stats;
+	lua_State* L = LuaAllocator::NewState(allocator_kind, &stats);
+	luaL_openlibs(L);
+	luaL_dostring(L,
+		"Mover = { OnUpdate = function(self)\n"
+		"  self.x = self.x + self.vx\n"
+		"  self.last = { x = self.x, y = self.y }\n"
+		"  self.label = 'actor_' .. self.id .. '_' .. self.ticks\n"
+		"  self.ticks = self.ticks + 1\n"
+		"end }");
+	LuaHeap::Configure(L);
+	{
+		luabridge::LuaRef type = luabridge::getGlobal(L, "Mover");
+		luabridge::LuaRef hook = type["OnUpdate"];
+		luabridge::LuaRef metatable = luabridge::newTable(L);
+		metatable["__index"] = type;
+		metatable["enabled"] = true;
+		std::vector<luabridge::LuaRef> instances;
+		for (int i = 0; i < actor_count; i++) {
+			lua_createtable(L, 0, 5);
+			metatable.push(L);
+			lua_setmetatable(L, -2);
+			luabridge::LuaRef instance = luabridge::LuaRef::fromStack(L, -1);
+			lua_pop(L, 1);
+			instance["id"] = i;
+			instance["x"] = 0.0;
+			instance["y"] = 0.0;
+			instance["vx"] = 1.0;
+			instance["ticks"] = 0;
+			instances.push_back(instance);
+		}
+		LuaHeap::FullCollect(L);
+		LuaAllocator::TakeFrame(&stats);
+
+		for (int frame = 0; frame < frames; frame++) {
+			uint64_t start = Profiler::Now();
+			for (auto& instance : instances) {
+				try {
+					hook(instance);
+				}
+				catch (const luabridge::LuaException& e) {
+					std::cout << e.what() << std::endl;
+				}
+			}
+			LuaHeap::Step(L);
+			run.frameTimes.push_back((Profiler::Now() - start) / 1.0e6);
+
+			LuaAllocStats frame_stats = LuaAllocator::TakeFrame(&stats);
+			run.allocCounts.push_back(static_cast<double>(frame_stats.allocations));
+			run.peakLiveBytes = std::max(run.peakLiveBytes, frame_stats.peakBytes);
+		}
+	}
+	size_t resident_after = Benchmark::ResidentKB();
+	run.residentGrowthKB = resident_after > resident_before ? resident_after - resident_before : 0;
+	lua_close(L);
+	return run;
+}
+
+void Benchmark::RunAllocatorBenchmark() {
+	const int actors = 10000;
+	const int frames = Benchmark::frameLimit > 0 ? Benchmark::frameLimit : 300;
+	std::vector<LUA_ALLOCATOR> kinds = { ALLOC_SYSTEM, ALLOC_POOLED };
+	if (Benchmark::allocatorChosen) {
+		kinds = { LuaAllocator::kind };
+	}
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "allocator benchmark: OnUpdate on " << actors << " actors, " << frames << " frames (ms)" << std::endl;
+	std::cout << "  allocator   frame mean    frame p99   allocs/frame   peak live KB   rss growth KB" << std::endl;
+	for (LUA_ALLOCATOR allocator_kind : kinds) {
+		AllocatorRun run = RunAllocatorScene(allocator_kind, actors, frames);
+		std::vector<double> sorted = run.frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		std::cout << "  " << std::left << std::setw(9) << LuaAllocator::KindName(allocator_kind) << std::right
+			<< "  " << std::setw(11) << Mean(sorted) << "  " << std::setw(11) << Percentile(sorted, 99.0)
+			<< "  " << std::setw(13) << std::setprecision(0) << Mean(run.allocCounts)
+			<< "  " << std::setw(13) << run.peakLiveBytes / 1024
+			<< "  " << std::setw(14) << run.residentGrowthKB << std::setprecision(3) << std::endl;
+	}
+	if (kinds.size() > 1) {
+		// Memory the first run gave back can be reused by the second, so its growth reads low.
+		std::cout << "  for rss, run each allocator in its own process with --lua-alloc" << std::endl;
+	}
+}
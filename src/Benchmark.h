@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Benchmark {
+public:
+	static inline bool headless = false;
+	static inline int frameLimit = 0; // 0 runs until the game quits
+	static inline bool dispatchBench = false; // Measure hook call overhead instead of running a game
+	static inline bool allocBench = false; // Compare Lua allocators on a synthetic 10k-actor scene
+	static inline bool allocatorChosen = false; // --lua-alloc was passed
+
+	static void ParseArgs(int argc, char* argv[]);
+	static void ConfigureHeadlessDrivers();
+	static void BeginFrame();
+	static bool EndFrame(); // Returns false once frameLimit frames have run
+	static void Report();
+	static void RunDispatchBenchmark();
+	static void RunAllocatorBenchmark();
+	static size_t ResidentKB();
+private:
+	static inline uint64_t frameStart = 0;
+	static inline std::vector<double> frameTimes;
+	static inline std::unordered_map<std::string, std::vector<double>> phaseTimes;
+	static inline std::vector<double> heapSizes; // Lua heap in KB at the end of each frame
+	static inline std::vector<double> gcStepTimes; // Time LuaHeap::Step spent collecting in each frame, in ms
+	static inline std::vector<double> allocCounts; // Lua blocks allocated during each frame
+	static inline size_t peakLiveBytes = 0;
+	Benchmark() {}
+};
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "Component.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+const char* Component::HOOK_NAMES[HOOK_COUNT] = {
+	"OnStart",
+	"OnUpdate",
+	"OnLateUpdate",
+	"OnDestroy",
+	"OnCollisionEnter",
+	"OnCollisionExit",
+	"OnTriggerEnter",
+	"OnTriggerExit",
+	"OnBecameVisible",
+	"OnBecameInvisible"
+};
+char Component::SIBLING_KEY = 0;
+
+std::unordered_map<const void*, Component*>& BoundTables() {
+	// Never deleted, so components released during static destruction can still unbind.
+	static auto* bound = new std::unordered_map<const void*, Component*>();
+	return *bound;
+}
+
+Component::~Component() {
+	// Scripts may keep the table alive after the engine lets go, so unhook the mirror first.
+	if (table != nullptr) {
+		auto it = BoundTables().find(table);
+		if (it != BoundTables().end() && it->second == this) {
+			BoundTables().erase(it);
+		}
+	}
+}
+
+void Component::BindTable() {
+	lua_State* L = state();
+	push(L);
+	table = lua_topointer(L, -1); // Lua never moves a table, and this one lives at least as long as we do
+	lua_pop(L, 1);
+	BoundTables()[table] = this;
+}
+
+void Component::ResolveHooks() {
+	// Resolved once at registration; the dispatch loops never look hooks up by name again.
+	for (int i = 0; i < HOOK_COUNT; i++) {
+		luabridge::LuaRef hook = (*this)[Component::HOOK_NAMES[i]];
+		if (hook.isFunction()) {
+			hooks[i] = hook;
+		}
+		else {
+			hooks[i].reset();
+		}
+	}
+}
+
+const std::string& Component::TypeName() {
+	if (typeName.empty()) {
+		typeName = (*this)["type"].tostring();
+	}
+	return typeName;
+}
+
+void Component::ResolvePolicy() {
+	policy = UpdatePolicy();
+	if (!isTable()) {
+		return;
+	}
+
+	luabridge::LuaRef every = (*this)["update_every"];
+	if (every.isNumber() && every.cast<int>() > 1) {
+		policy.every = static_cast<uint32_t>(every.cast<int>());
+	}
+	luabridge::LuaRef radius = (*this)["update_radius"];
+	if (radius.isNumber() && radius.cast<float>() > 0.0f) {
+		policy.radius2 = radius.cast<float>() * radius.cast<float>();
+	}
+	luabridge::LuaRef when_visible = (*this)["update_when_visible"];
+	policy.whenVisible = when_visible.isBool() && when_visible.cast<bool>();
+}
+
+int Component::NewIndex(lua_State* L) {
+	// Stack: instance, key, value. Only reached for keys the instance does not hold raw.
+	if (lua_type(L, 2) == LUA_TSTRING && std::strcmp(lua_tostring(L, 2), "enabled") == 0) {
+		// "enabled" lives in the metatable's __index lookup, which is shared by every instance in the same
+		// state, so flipping it means moving this instance over to the twin.
+		bool value = lua_toboolean(L, 3);
+		lua_getmetatable(L, 1);
+		lua_pushliteral(L, "__index");
+		lua_rawget(L, -2);
+		lua_pushvalue(L, 2);
+		lua_rawget(L, -2);
+		bool current = lua_toboolean(L, -1);
+		lua_pop(L, 2);
+		if (current != value) {
+			lua_pushlightuserdata(L, &Component::SIBLING_KEY);
+			lua_rawget(L, -2);
+			if (lua_istable(L, -1)) {
+				lua_setmetatable(L, 1);
+			}
+			else {
+				lua_pop(L, 1);
+			}
+		}
+		lua_pop(L, 1);
+
+		auto it = BoundTables().find(lua_topointer(L, 1));
+		if (it != BoundTables().end()) {
+			it->second->enabled = value;
+		}
+		return 0;
+	}
+
+	lua_settop(L, 3);
+	lua_rawset(L, 1);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+enum HOOK_TYPE {
+	HOOK_START,
+	HOOK_UPDATE,
+	HOOK_LATE_UPDATE,
+	HOOK_DESTROY,
+	HOOK_COLLISION_ENTER,
+	HOOK_COLLISION_EXIT,
+	HOOK_TRIGGER_ENTER,
+	HOOK_TRIGGER_EXIT,
+	HOOK_BECAME_VISIBLE,
+	HOOK_BECAME_INVISIBLE,
+	HOOK_COUNT
+};
+
+/* When OnUpdate and OnLateUpdate run, from the update_every, update_radius and update_when_visible
+   fields of the instance or its type. Read when the component is registered with the HookTable. */
+struct UpdatePolicy {
+	uint32_t every = 1; // Runs one frame in every this many, staggered by actor ID
+	float radius2 = 0.0f; // Squared distance from the camera; 0 is no limit
+	bool whenVisible = false;
+
+	bool Gated() const {
+		return every > 1 || radius2 > 0.0f || whenVisible;
+	}
+};
+
+/* A component's Lua table (or C++ userdata) plus the native state the per-frame dispatch reads. */
+class Component : public luabridge::LuaRef {
+public:
+	static const char* HOOK_NAMES[HOOK_COUNT];
+	static char SIBLING_KEY; // Address is the key, in a shared instance metatable, of its twin for the other "enabled"
+
+	uint32_t keyId = 0; // Interned "key", ordered through ComponentDB::KeyRank
+	bool detached = false; // Left the HookTable; its entries are skipped until the next Compact
+	uint32_t attachment = 0; // Bumped on every detach, so entries from before a pooled actor's reuse stay dead
+	UpdatePolicy policy;
+	bool onScreen = false; // As last reported through OnBecameVisible/OnBecameInvisible
+
+	explicit Component(const luabridge::LuaRef& ref) : luabridge::LuaRef(ref) {}
+	~Component();
+	Component(const Component&) = delete;
+	Component& operator=(const Component&) = delete;
+
+	bool IsEnabled() const {
+		return *enabledFlag;
+	}
+	bool HasHook(HOOK_TYPE hook) const {
+		return hooks[hook].has_value();
+	}
+	const luabridge::LuaRef& Ref() const {
+		return *this; // Passing the Component itself to Lua would try to push it as a userdata class
+	}
+	const luabridge::LuaRef& Hook(HOOK_TYPE hook) const {
+		return *hooks[hook];
+	}
+	template <class... Args>
+	void Invoke(HOOK_TYPE hook, const Args&... args) {
+		(*hooks[hook])(Ref(), args...);
+	}
+
+	void ResolveHooks();
+	void ResolvePolicy();
+	const std::string& TypeName(); // "type", read from Lua the first time it is asked for
+	void BindTable(); // Lets writes to the instance's "enabled" find this Component
+	void SetEnabledMirror(bool value) {
+		enabled = value;
+	}
+	void BindEnabled(bool* native_flag) {
+		enabledFlag = native_flag;
+	}
+
+	static int NewIndex(lua_State* L);
+private:
+	bool enabled = true; // Mirror of the Lua-side flag for script components
+	bool* enabledFlag = &enabled; // Rigidbody/ParticleSystem point this at their own member instead
+	const void* table = nullptr; // Set by BindTable
+	std::string typeName;
+	std::optional<luabridge::LuaRef> hooks[HOOK_COUNT];
+};
\ No newline at end of file
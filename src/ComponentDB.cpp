@@ -2,17 +2,29 @@
 #include "AudioDB.h"
 #include "ComponentDB.h"
 #include "DataManager.h"
+#include "HookTable.h"
 #include "ImageDB.h"
 #include "InputManager.h"
+#include "JobSystem.h"
+#include "LuaAllocator.h"
+#include "LuaHeap.h"
 #include "ParticleSystem.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "Rigidbody.h"
 #include "SceneDB.h"
+#include "SceneLoader.h"
+#include "ScriptCache.h"
+#include "SpatialIndex.h"
 #include "TextDB.h"
+#include "Time.h"
+#include "WorldStreamer.h"
 
 #include "Helper.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <iterator>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -25,6 +37,8 @@
 
 lua_State* ComponentDB::lua_state = nullptr;
 std::unordered_map<std::string, std::optional<luabridge::LuaRef>> ComponentDB::componentCache;
+std::map<std::string, uint32_t> ComponentDB::keyIds;
+std::vector<uint32_t> ComponentDB::keyRanks;
 int ComponentDB::runtimeAddCount = 0;
 
 void CppDebugLog(const std::string& message) {
@@ -36,10 +50,15 @@ void Quit() {
 }
 
 void Sleep(const int dur_ms) {
-	std::this_thread::sleep_for(std::chrono::milliseconds(dur_ms));
+	// Lend the main thread to the job pool instead of idling it.
+	JobSystem::HelpUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(dur_ms));
 }
 
 int GetFrame() {
+	if (Renderer::threaded) {
+		// frame_number is advanced on the render thread, which runs up to a frame behind.
+		return Renderer::GetSubmittedFrames();
+	}
 	return Helper::GetFrameNumber();
 }
 
@@ -65,7 +84,7 @@ std::string ReturnVector2Type() {
 }
 
 void ComponentDB::LuaInit() {
-	ComponentDB::lua_state = luaL_newstate();
+	ComponentDB::lua_state = LuaAllocator::NewState(LuaAllocator::kind, &LuaAllocator::stats);
 	luaL_openlibs(ComponentDB::GetLuaState());
 
 	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
@@ -102,6 +121,9 @@ void ComponentDB::LuaInit() {
 
 	Actor::LuaInit();
 	SceneDB::LuaInit();
+	SceneLoader::LuaInit();
+	WorldStreamer::LuaInit();
+	SpatialIndex::LuaInit();
 	Input::LuaInit();
 	TextDB::LuaInit();
 	AudioDB::LuaInit();
@@ -110,21 +132,52 @@ void ComponentDB::LuaInit() {
 	Rigidbody::LuaInit();
 	ParticleSystem::LuaInit();
 	DataManager::LuaInit();
+	Time::LuaInit();
+	Profiler::LuaInit();
+
+	LuaHeap::Configure(ComponentDB::GetLuaState());
 }
 
 void ComponentDB::ReportError(const std::string& actor_name, const luabridge::LuaException& e) {
-	std::string error_message = e.what();
+	ComponentDB::ReportError(actor_name, std::string(e.what()));
+}
+
+void ComponentDB::ReportError(const std::string& actor_name, const std::string& message) {
+	std::string error_message = message;
 	std::replace(error_message.begin(), error_message.end(), '\\', '/');
 
 	std::cout << "\033[31m" << actor_name << " : "
 		<< error_message << "\033[0m" << std::endl;
 }
 
-void ComponentDB::ComponentInsertSort(std::vector<std::shared_ptr<luabridge::LuaRef>>& components) {
+uint32_t ComponentDB::InternKey(const std::string& key) {
+	auto [itr, inserted] = ComponentDB::keyIds.try_emplace(key, static_cast<uint32_t>(ComponentDB::keyRanks.size()));
+	if (!inserted) {
+		return itr->second;
+	}
+	ComponentDB::keyRanks.push_back(0);
+
+	// Ranks follow string order, so comparing two ranks is the same as comparing the keys.
+	// A new key takes the midpoint of its neighbours; when there is no gap left, respace them all.
+	uint64_t low = itr == ComponentDB::keyIds.begin() ? 0 : ComponentDB::keyRanks[std::prev(itr)->second];
+	uint64_t high = std::next(itr) == ComponentDB::keyIds.end() ? UINT32_MAX : ComponentDB::keyRanks[std::next(itr)->second];
+	if (high - low >= 2) {
+		ComponentDB::keyRanks[itr->second] = static_cast<uint32_t>((low + high) / 2);
+	}
+	else {
+		uint32_t step = static_cast<uint32_t>(UINT32_MAX / (ComponentDB::keyIds.size() + 1));
+		uint32_t rank = 0;
+		for (auto& interned : ComponentDB::keyIds) {
+			rank += step;
+			ComponentDB::keyRanks[interned.second] = rank;
+		}
+	}
+	return itr->second;
+}
+
+void ComponentDB::ComponentInsertSort(std::vector<std::shared_ptr<Component>>& components) {
 	for (auto itr = components.end() - 1; itr != components.begin(); --itr) {
-		std::string key1 = (*(*itr))["key"].cast<std::string>();
-		std::string key2 = (*(*(itr - 1)))["key"].cast<std::string>();
-		if (key1 < key2) {
+		if (ComponentDB::KeyRank((*itr)->keyId) < ComponentDB::KeyRank((*(itr - 1))->keyId)) {
 			auto temp = *itr;
 			*itr = *(itr - 1);
 			*(itr - 1) = temp;
@@ -132,341 +185,297 @@ void ComponentDB::ComponentInsertSort(std::vector<std::shared_ptr<luabridge::Lua
 	}
 }
 
-void ComponentDB::LoadComponent(Actor* actor, const std::string& component, const std::string& key,
-	rapidjson::GenericMemberIterator<false, rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>> value) {
-	if (component != "Rigidbody" && component != "ParticleSystem") {
-		luabridge::LuaRef parentTable = luabridge::LuaRef(ComponentDB::GetLuaState());
-
-		try {
-			parentTable = ComponentDB::componentCache.at(component).value();
-		}
-		catch (const std::out_of_range&) {
-			std::string componentPath = "resources/component_types/" + component + ".lua";
-			if (!std::filesystem::exists(componentPath)) {
-				std::cout << "error: failed to locate component "
-					<< component;
-				std::exit(0);
-			}
-			if (luaL_dofile(ComponentDB::GetLuaState(), componentPath.c_str()) != LUA_OK) {
-				std::cout << "problem with lua file " << component;
-				std::exit(0);
-			}
-			ComponentDB::componentCache[component] = luabridge::getGlobal(ComponentDB::GetLuaState(), component.c_str());
-			parentTable = ComponentDB::componentCache.at(component).value();
-		}
-		auto instanceTable = std::make_shared<luabridge::LuaRef>(luabridge::newTable(ComponentDB::GetLuaState()));
-		ComponentDB::EstablishInheritance(*instanceTable, parentTable);
-		(*instanceTable)["key"] = key;
-		(*instanceTable)["type"] = component;
-		(*instanceTable)["enabled"] = true;
-		(*instanceTable)["removed"] = false;
-
-		for (auto itr = value->value.MemberBegin();
-			itr != value->value.MemberEnd(); ++itr) {
-			if (std::string(itr->name.GetString()) == "type") {
-				continue;
-			}
-			else {
-				ComponentDB::LoadOverride(*instanceTable, itr);
-			}
-		}
-		actor->InjectConvenienceReference(instanceTable);
-
-		actor->keyedComponents.insert(std::pair(key, instanceTable));
-		actor->typedComponents[component].push_back(instanceTable);
-		ComponentDB::ComponentInsertSort(actor->typedComponents[component]);
-
-		if ((*instanceTable)["OnStart"].isFunction()) {
-			actor->startingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->startingComponents);
-		}
-
-		if ((*instanceTable)["OnDestroy"].isFunction()) {
-			actor->destroyingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->destroyingComponents);
-		}
-
-		if ((*instanceTable)["OnUpdate"].isFunction()) {
-			actor->updatingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->updatingComponents);
-		}
-
-		if ((*instanceTable)["OnLateUpdate"].isFunction()) {
-			actor->lateUpdatingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->lateUpdatingComponents);
-		}
-
-		if ((*instanceTable)["OnCollisionEnter"].isFunction()) {
-			actor->collisionEnterComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->collisionEnterComponents);
-		}
+luabridge::LuaRef ComponentDB::LoadComponentType(const std::string& component) {
+	auto cached = ComponentDB::componentCache.find(component);
+	if (cached != ComponentDB::componentCache.end()) {
+		return cached->second.value();
+	}
 
-		if ((*instanceTable)["OnCollisionExit"].isFunction()) {
-			actor->collisionExitComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->collisionExitComponents);
-		}
+	std::string componentPath = "resources/component_types/" + component + ".lua";
+	if (!std::filesystem::exists(componentPath)) {
+		std::cout << "error: failed to locate component "
+			<< component;
+		std::exit(0);
+	}
+	lua_State* L = ComponentDB::GetLuaState();
+	if (ScriptCache::Load(L, componentPath) != LUA_OK || lua_pcall(L, 0, 0, 0) != LUA_OK) {
+		std::cout << "problem with lua file " << component;
+		std::exit(0);
+	}
+	ComponentDB::componentCache[component] = luabridge::getGlobal(L, component.c_str());
+	return ComponentDB::componentCache.at(component).value();
+}
 
-		if ((*instanceTable)["OnTriggerEnter"].isFunction()) {
-			actor->triggerEnterComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->triggerEnterComponents);
-		}
+std::shared_ptr<Component> ComponentDB::NewScriptInstance(const std::string& component, const std::string& key, int override_count) {
+	lua_State* L = ComponentDB::GetLuaState();
+	luabridge::LuaRef parentTable = ComponentDB::LoadComponentType(component);
+	// key, type, removed and the actor reference, plus whatever the scene or template overrides
+	auto instanceTable = ComponentDB::NewInstance(parentTable, true, 4 + override_count);
+
+	// Raw sets: none of these is "enabled", so going through __newindex would only cost a C call each.
+	instanceTable->push(L);
+	lua_pushstring(L, "key");
+	lua_pushlstring(L, key.data(), key.size());
+	lua_rawset(L, -3);
+	lua_pushstring(L, "type");
+	lua_pushlstring(L, component.data(), component.size());
+	lua_rawset(L, -3);
+	lua_pushstring(L, "removed");
+	lua_pushboolean(L, false);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+
+	instanceTable->keyId = ComponentDB::InternKey(key);
+	return instanceTable;
+}
 
-		if ((*instanceTable)["OnTriggerExit"].isFunction()) {
-			actor->triggerExitComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->triggerExitComponents);
-		}
+std::shared_ptr<Component> ComponentDB::NewComponent(Actor* actor, const std::string& component, const std::string& key,
+	int override_count) {
+	if (component != "Rigidbody" && component != "ParticleSystem") {
+		return ComponentDB::NewScriptInstance(component, key, override_count);
 	}
 	else if (component == "Rigidbody") {
 		Rigidbody* temp = new Rigidbody();
 		luabridge::LuaRef ref(ComponentDB::GetLuaState(), temp);
-		auto component = std::make_shared<luabridge::LuaRef>(ref);
+		auto component = std::make_shared<Component>(ref);
+		component->BindEnabled(&temp->enabled);
 		temp->key = key;
 		temp->actor = actor;
-
-		for (auto itr = value->value.MemberBegin();
-			itr != value->value.MemberEnd(); ++itr) {
-			if (std::string(itr->name.GetString()) == "type") {
-				continue;
-			}
-			else {
-				ComponentDB::LoadOverride(*component, itr);
-			}
-		}
-
-		actor->keyedComponents.insert(std::pair(key, component));
-		actor->typedComponents[temp->type].push_back(component);
-		ComponentInsertSort(actor->typedComponents[temp->type]);
-
-		actor->startingComponents.push_back(component);
-		ComponentInsertSort(actor->startingComponents);
-		actor->destroyingComponents.push_back(component);
-		ComponentInsertSort(actor->destroyingComponents);
+		component->keyId = ComponentDB::InternKey(key);
+		return component;
 	}
-	else if (component == "ParticleSystem") {
+	else {
 		ParticleSystem* temp = new ParticleSystem();
 		luabridge::LuaRef ref(ComponentDB::GetLuaState(), temp);
-		auto component = std::make_shared<luabridge::LuaRef>(ref);
+		auto component = std::make_shared<Component>(ref);
+		component->BindEnabled(&temp->enabled);
 		temp->key = key;
 		temp->actor = actor;
+		component->keyId = ComponentDB::InternKey(key);
+		return component;
+	}
+}
 
-		for (auto itr = value->value.MemberBegin();
-			itr != value->value.MemberEnd(); ++itr) {
-			if (std::string(itr->name.GetString()) == "type") {
-				continue;
-			}
-			else {
-				ComponentDB::LoadOverride(*component, itr);
-			}
-		}
+void ComponentDB::AttachComponent(Actor* actor, std::shared_ptr<Component>& instance, const std::string& component,
+	const std::string& key) {
+	if (!(*instance).isUserdata()) {
+		actor->InjectConvenienceReference(instance);
+	}
+	instance->ResolveHooks();
 
-		actor->keyedComponents.insert(std::pair(key, component));
-		actor->typedComponents[temp->type].push_back(component);
-		ComponentInsertSort(actor->typedComponents[temp->type]);
+	actor->keyedComponents.insert(std::pair(key, instance));
+	actor->typedComponents[component].push_back(instance);
+	ComponentDB::ComponentInsertSort(actor->typedComponents[component]);
+}
 
-		actor->startingComponents.push_back(component);
-		ComponentInsertSort(actor->startingComponents);
-		actor->updatingComponents.push_back(component);
-		ComponentInsertSort(actor->updatingComponents);
+void ComponentDB::LoadComponent(Actor* actor, const std::string& component, const std::string& key,
+	rapidjson::GenericMemberIterator<false, rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>> value) {
+	auto instance = ComponentDB::NewComponent(actor, component, key, static_cast<int>(value->value.MemberCount()));
+	for (auto itr = value->value.MemberBegin();
+		itr != value->value.MemberEnd(); ++itr) {
+		if (std::string(itr->name.GetString()) == "type") {
+			continue;
+		}
+		else {
+			ComponentDB::LoadOverride(*instance, itr);
+		}
 	}
+	ComponentDB::AttachComponent(actor, instance, component, key);
 }
 
-void ComponentDB::LoadSystemComponent(Actor* actor, const std::string& component, const std::string& key) {
-	if (component != "Rigidbody" && component != "ParticleSystem") {
-		luabridge::LuaRef parentTable = luabridge::LuaRef(ComponentDB::GetLuaState());
+void ComponentDB::LoadCookedComponent(Actor* actor, const CookedFile& file, const CookedComponent& cooked) {
+	std::string key = file.String(cooked.key);
+	std::string component = file.String(cooked.type);
+	auto instance = ComponentDB::NewComponent(actor, component, key, static_cast<int>(cooked.overrideCount));
+	ComponentDB::LoadCookedOverrides(*instance, file, cooked);
+	ComponentDB::AttachComponent(actor, instance, component, key);
+}
 
-		try {
-			parentTable = ComponentDB::componentCache.at(component).value();
+void ComponentDB::LoadCookedOverrides(luabridge::LuaRef component, const CookedFile& file, const CookedComponent& cooked) {
+	for (uint32_t i = 0; i < cooked.overrideCount; i++) {
+		const CookedOverride& value = file.OverrideAt(cooked.firstOverride + i);
+		const char* field = file.String(value.field);
+		switch (value.kind) {
+		case COOKED_INT:
+			component[field] = value.value.i;
+			break;
+		case COOKED_FLOAT:
+			component[field] = value.value.f;
+			break;
+		case COOKED_STRING:
+			component[field] = file.String(value.value.s);
+			break;
+		default:
+			component[field] = value.value.b != 0;
+			break;
 		}
-		catch (const std::out_of_range&) {
-			std::string componentPath = "resources/component_types/" + component + ".lua";
-			if (!std::filesystem::exists(componentPath)) {
-				std::cout << "error: failed to locate component "
-					<< component;
-				std::exit(0);
-			}
-			if (luaL_dofile(ComponentDB::GetLuaState(), componentPath.c_str()) != LUA_OK) {
-				std::cout << "problem with lua file " << component;
-				std::exit(0);
-			}
-			ComponentDB::componentCache[component] = luabridge::getGlobal(ComponentDB::GetLuaState(), component.c_str());
-			parentTable = ComponentDB::componentCache.at(component).value();
-		}
-		auto instanceTable = std::make_shared<luabridge::LuaRef>(luabridge::newTable(ComponentDB::GetLuaState()));
-		ComponentDB::EstablishInheritance(*instanceTable, parentTable);
-		(*instanceTable)["key"] = key;
-		(*instanceTable)["type"] = component;
-		(*instanceTable)["enabled"] = true;
-		(*instanceTable)["removed"] = false;
+	}
+}
 
+void ComponentDB::LoadSystemComponent(Actor* actor, const std::string& component, const std::string& key) {
+	if (component != "Rigidbody" && component != "ParticleSystem") {
+		auto instanceTable = ComponentDB::NewScriptInstance(component, key, 0);
 		actor->InjectConvenienceReference(instanceTable);
+		instanceTable->ResolveHooks();
 
 		actor->keyedComponents.insert(std::pair(key, instanceTable));
 		actor->typedComponents[component].push_back(instanceTable);
 		ComponentDB::ComponentInsertSort(actor->typedComponents[component]);
-
-		if ((*instanceTable)["OnStart"].isFunction()) {
-			actor->startingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->startingComponents);
-		}
-
-		if ((*instanceTable)["OnDestroy"].isFunction()) {
-			actor->destroyingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->destroyingComponents);
-		}
-
-		if ((*instanceTable)["OnUpdate"].isFunction()) {
-			actor->updatingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->updatingComponents);
-		}
-
-		if ((*instanceTable)["OnLateUpdate"].isFunction()) {
-			actor->lateUpdatingComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->lateUpdatingComponents);
-		}
-
-		if ((*instanceTable)["OnCollisionEnter"].isFunction()) {
-			actor->collisionEnterComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->collisionEnterComponents);
-		}
-
-		if ((*instanceTable)["OnCollisionExit"].isFunction()) {
-			actor->collisionExitComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->collisionExitComponents);
-		}
-
-		if ((*instanceTable)["OnTriggerEnter"].isFunction()) {
-			actor->triggerEnterComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->triggerEnterComponents);
-		}
-
-		if ((*instanceTable)["OnTriggerExit"].isFunction()) {
-			actor->triggerExitComponents.push_back(instanceTable);
-			ComponentDB::ComponentInsertSort(actor->triggerExitComponents);
-		}
 	}
 	else if (component == "Rigidbody") {
 		Rigidbody* temp = new Rigidbody();
 		luabridge::LuaRef ref(ComponentDB::GetLuaState(), temp);
-		auto component = std::make_shared<luabridge::LuaRef>(ref);
+		auto component = std::make_shared<Component>(ref);
+		component->BindEnabled(&temp->enabled);
+		component->ResolveHooks();
 		temp->key = key;
 		temp->actor = actor;
+		component->keyId = ComponentDB::InternKey(key);
 
 		actor->keyedComponents.insert(std::pair(key, component));
 		actor->typedComponents[temp->type].push_back(component);
 		ComponentInsertSort(actor->typedComponents[temp->type]);
-
-		actor->startingComponents.push_back(component);
-		ComponentInsertSort(actor->startingComponents);
-		actor->destroyingComponents.push_back(component);
-		ComponentInsertSort(actor->destroyingComponents);
 	}
 	else if (component == "ParticleSystem") {
 		ParticleSystem* temp = new ParticleSystem();
 		luabridge::LuaRef ref(ComponentDB::GetLuaState(), temp);
-		auto component = std::make_shared<luabridge::LuaRef>(ref);
+		auto component = std::make_shared<Component>(ref);
+		component->BindEnabled(&temp->enabled);
+		component->ResolveHooks();
 		temp->key = key;
 		temp->actor = actor;
+		component->keyId = ComponentDB::InternKey(key);
 
 		actor->keyedComponents.insert(std::pair(key, component));
 		actor->typedComponents[temp->type].push_back(component);
 		ComponentInsertSort(actor->typedComponents[temp->type]);
-
-		actor->startingComponents.push_back(component);
-		ComponentInsertSort(actor->startingComponents);
-		actor->updatingComponents.push_back(component);
-		ComponentInsertSort(actor->updatingComponents);
 	}
 }
 
-void ComponentDB::EstablishInheritance(luabridge::LuaRef& instanceTable, luabridge::LuaRef& parentTable) {
-	luabridge::LuaRef newMetatable = luabridge::newTable(ComponentDB::GetLuaState());
-	newMetatable["__index"] = parentTable;
+const SharedMetatables& ComponentDB::MetatablesFor(const luabridge::LuaRef& parentTable) {
+	lua_State* L = ComponentDB::GetLuaState();
+	parentTable.push(L);
+	const void* parent = lua_topointer(L, -1);
+	lua_pop(L, 1);
+	auto cached = ComponentDB::sharedMetatables.find(parent);
+	if (cached != ComponentDB::sharedMetatables.end()) {
+		return cached->second;
+	}
+
+	// Each twin's __index is a one-field {enabled = b} lookup, and both lookups sit on one {__index = parent},
+	// so an instance's reads reach "enabled" and the parent but never the twin's __newindex or sibling link.
+	// "enabled" is never a raw field of an instance, so every write to it goes through __newindex,
+	// which moves the instance to the other twin and keeps the native mirror in sync.
+	lua_createtable(L, 0, 1);
+	parentTable.push(L);
+	lua_setfield(L, -2, "__index");
+	for (int enabled = 1; enabled >= 0; enabled--) {
+		lua_createtable(L, 0, 3);
+		lua_createtable(L, 0, 1);
+		lua_pushboolean(L, enabled);
+		lua_setfield(L, -2, "enabled");
+		lua_pushvalue(L, -3 - (1 - enabled));
+		lua_setmetatable(L, -2);
+		lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, &Component::NewIndex);
+		lua_setfield(L, -2, "__newindex");
+	}
+	// Stack: link, enabled twin, disabled twin
+	lua_pushlightuserdata(L, &Component::SIBLING_KEY);
+	lua_pushvalue(L, -3);
+	lua_rawset(L, -3);
+	lua_pushlightuserdata(L, &Component::SIBLING_KEY);
+	lua_pushvalue(L, -2);
+	lua_rawset(L, -4);
+
+	luabridge::LuaRef disabled = luabridge::LuaRef::fromStack(L, -1);
+	luabridge::LuaRef enabled = luabridge::LuaRef::fromStack(L, -2);
+	lua_pop(L, 3);
+	return ComponentDB::sharedMetatables.emplace(parent, SharedMetatables{ enabled, disabled }).first->second;
+}
 
-	instanceTable.push(ComponentDB::GetLuaState());
-	newMetatable.push(ComponentDB::GetLuaState());
-	lua_setmetatable(ComponentDB::GetLuaState(), -2);
-	lua_pop(ComponentDB::GetLuaState(), 1);
+std::shared_ptr<Component> ComponentDB::NewInstance(const luabridge::LuaRef& parentTable, bool enabled, int field_count) {
+	lua_State* L = ComponentDB::GetLuaState();
+	const SharedMetatables& metatables = ComponentDB::MetatablesFor(parentTable);
+	lua_createtable(L, 0, field_count);
+	(enabled ? metatables.enabled : metatables.disabled).push(L);
+	lua_setmetatable(L, -2);
+	auto instanceTable = std::make_shared<Component>(luabridge::LuaRef::fromStack(L, -1));
+	lua_pop(L, 1);
+
+	instanceTable->BindTable();
+	instanceTable->SetEnabledMirror(enabled);
+	return instanceTable;
 }
 
 void ComponentDB::ComponentCopy(Actor* actor, Actor* templateActor) {
 	for (auto& component : templateActor->keyedComponents) {
 		if (!((*component.second).isUserdata())) {
-			auto instanceTable = std::make_shared<luabridge::LuaRef>(luabridge::newTable(ComponentDB::GetLuaState()));
-			EstablishInheritance(*instanceTable, *(component.second));
+			// Only the actor reference is set on a copy; everything else is read through from the template.
+			auto instanceTable = ComponentDB::NewInstance(*component.second, component.second->IsEnabled(), 1);
+			instanceTable->keyId = component.second->keyId;
 			actor->InjectConvenienceReference(instanceTable);
+			instanceTable->ResolveHooks();
 			actor->keyedComponents.insert(
 				std::pair((*instanceTable)["key"].cast<std::string>(), instanceTable));
 			actor->typedComponents[(*instanceTable)["type"].cast<std::string>()].push_back(instanceTable);
-
-			if ((*instanceTable)["OnStart"].isFunction()) {
-				actor->startingComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->startingComponents);
-			}
-
-			if ((*instanceTable)["OnUpdate"].isFunction()) {
-				actor->updatingComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->updatingComponents);
-			}
-
-			if ((*instanceTable)["OnLateUpdate"].isFunction()) {
-				actor->lateUpdatingComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->lateUpdatingComponents);
-			}
-
-			if ((*instanceTable)["OnCollisionEnter"].isFunction()) {
-				actor->collisionEnterComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->collisionEnterComponents);
-			}
-
-			if ((*instanceTable)["OnCollisionExit"].isFunction()) {
-				actor->collisionExitComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->collisionExitComponents);
-			}
-
-			if ((*instanceTable)["OnTriggerEnter"].isFunction()) {
-				actor->triggerEnterComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->triggerEnterComponents);
-			}
-
-			if ((*instanceTable)["OnTriggerExit"].isFunction()) {
-				actor->triggerExitComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->triggerExitComponents);
-			}
-
-			if ((*instanceTable)["OnDestroy"].isFunction()) {
-				actor->destroyingComponents.push_back(instanceTable);
-				ComponentDB::ComponentInsertSort(actor->destroyingComponents);
-			}
 		}
 		else if ((*component.second)["type"].cast<std::string>() == "Rigidbody") {
 			Rigidbody* rb = new Rigidbody((*(component.second)).cast<Rigidbody*>());
 			luabridge::LuaRef ref(ComponentDB::GetLuaState(), rb);
-			auto refComp = std::make_shared<luabridge::LuaRef>(ref);
+			auto refComp = std::make_shared<Component>(ref);
+			refComp->BindEnabled(&rb->enabled);
+			refComp->ResolveHooks();
 			rb->actor = actor;
+			refComp->keyId = component.second->keyId;
 
 			actor->keyedComponents.insert(std::pair(rb->key, refComp));
 			actor->typedComponents[rb->type].push_back(refComp);
 			ComponentInsertSort(actor->typedComponents[rb->type]);
-
-			actor->startingComponents.push_back(refComp);
-			ComponentInsertSort(actor->startingComponents);
-			actor->destroyingComponents.push_back(refComp);
-			ComponentInsertSort(actor->destroyingComponents);
 		}
 		else if ((*component.second)["type"].cast<std::string>() == "ParticleSystem") {
 			ParticleSystem* ps = new ParticleSystem((*(component.second)).cast<ParticleSystem*>());
 			luabridge::LuaRef ref(ComponentDB::GetLuaState(), ps);
-			auto refComp = std::make_shared<luabridge::LuaRef>(ref);
+			auto refComp = std::make_shared<Component>(ref);
+			refComp->BindEnabled(&ps->enabled);
+			refComp->ResolveHooks();
 			ps->actor = actor;
+			refComp->keyId = component.second->keyId;
 
 			actor->keyedComponents.insert(std::pair(ps->key, refComp));
 			actor->typedComponents[ps->type].push_back(refComp);
 			ComponentInsertSort(actor->typedComponents[ps->type]);
+		}
+	}
+}
 
-			actor->startingComponents.push_back(refComp);
-			ComponentInsertSort(actor->startingComponents);
-			actor->updatingComponents.push_back(refComp);
-			ComponentInsertSort(actor->updatingComponents);
+void ComponentDB::ComponentReset(Actor* actor, Actor* templateActor) {
+	lua_State* L = ComponentDB::GetLuaState();
+	for (auto& component : templateActor->keyedComponents) {
+		auto& target = actor->keyedComponents.at(component.first);
+		if (!((*component.second).isUserdata())) {
+			// Everything the instance set on itself goes, so lookups fall through to the template again.
+			target->push(L);
+			lua_pushnil(L);
+			while (lua_next(L, -2) != 0) {
+				lua_pop(L, 1);
+				lua_pushvalue(L, -1);
+				lua_pushnil(L);
+				lua_rawset(L, -4); // Clearing a field that lua_next has already visited is allowed
+			}
+			lua_pop(L, 1);
+			(*target)["enabled"] = component.second->IsEnabled();
+			target->ResolveHooks();
+		}
+		else if ((*component.second)["type"].cast<std::string>() == "Rigidbody") {
+			Rigidbody* rb = (*target).cast<Rigidbody*>();
+			*rb = Rigidbody((*(component.second)).cast<Rigidbody*>());
+			rb->actor = actor;
+		}
+		else if ((*component.second)["type"].cast<std::string>() == "ParticleSystem") {
+			ParticleSystem* ps = (*target).cast<ParticleSystem*>();
+			*ps = ParticleSystem((*(component.second)).cast<ParticleSystem*>());
+			ps->actor = actor;
 		}
 	}
 }
@@ -491,35 +500,11 @@ void ComponentDB::LoadOverride(luabridge::LuaRef component,
 	}
 }
 
-std::shared_ptr<luabridge::LuaRef> ComponentDB::RuntimeComponentLoad(Actor* actor, const std::string& component) {
+std::shared_ptr<Component> ComponentDB::RuntimeComponentLoad(Actor* actor, const std::string& component) {
 	if (component != "Rigidbody") {
-		luabridge::LuaRef parentTable = luabridge::LuaRef(ComponentDB::GetLuaState());
-
-		try {
-			parentTable = ComponentDB::componentCache.at(component).value();
-		}
-		catch (const std::out_of_range&) {
-			std::string componentPath = "resources/component_types/" + component + ".lua";
-			if (!std::filesystem::exists(componentPath)) {
-				std::cout << "error: failed to locate component "
-					<< component;
-				std::exit(0);
-			}
-			if (luaL_dofile(ComponentDB::GetLuaState(), componentPath.c_str()) != LUA_OK) {
-				std::cout << "problem with lua file " << component;
-				std::exit(0);
-			}
-			ComponentDB::componentCache[component] = luabridge::getGlobal(ComponentDB::GetLuaState(), component.c_str());
-			parentTable = ComponentDB::componentCache.at(component).value();
-		}
-		auto instanceTable = std::make_shared<luabridge::LuaRef>(luabridge::newTable(ComponentDB::GetLuaState()));
-		ComponentDB::EstablishInheritance(*instanceTable, parentTable);
 		std::string key = "r" + std::to_string(ComponentDB::runtimeAddCount);
 		ComponentDB::runtimeAddCount++;
-		(*instanceTable)["key"] = key;
-		(*instanceTable)["type"] = component;
-		(*instanceTable)["enabled"] = true;
-		(*instanceTable)["removed"] = false;
+		auto instanceTable = ComponentDB::NewScriptInstance(component, key, 0);
 		actor->InjectConvenienceReference(instanceTable);
 
 		actor->addedComponents.push_back(instanceTable);
@@ -529,44 +514,42 @@ std::shared_ptr<luabridge::LuaRef> ComponentDB::RuntimeComponentLoad(Actor* acto
 	else if (component == "Rigidbody") {
 		Rigidbody* temp = new Rigidbody();
 		luabridge::LuaRef ref(ComponentDB::GetLuaState(), temp);
-		auto component = std::make_shared<luabridge::LuaRef>(ref);
+		auto component = std::make_shared<Component>(ref);
+		component->BindEnabled(&temp->enabled);
+		component->ResolveHooks();
 		std::string key = "r" + std::to_string(ComponentDB::runtimeAddCount);
 		ComponentDB::runtimeAddCount++;
 		temp->key = key;
 		temp->actor = actor;
+		component->keyId = ComponentDB::InternKey(key);
 
 		actor->keyedComponents.insert(std::pair(key, component));
 		actor->typedComponents[temp->type].push_back(component);
 		ComponentInsertSort(actor->typedComponents[temp->type]);
-
-		actor->startingComponents.push_back(component);
-		ComponentInsertSort(actor->startingComponents);
-		actor->destroyingComponents.push_back(component);
-		ComponentInsertSort(actor->destroyingComponents);
+		HookTable::RegisterComponent(actor, component);
 
 		return component;
 	}
 	else if (component == "ParticleSystem") {
 		ParticleSystem* temp = new ParticleSystem();
 		luabridge::LuaRef ref(ComponentDB::GetLuaState(), temp);
-		auto component = std::make_shared<luabridge::LuaRef>(ref);
+		auto component = std::make_shared<Component>(ref);
+		component->BindEnabled(&temp->enabled);
+		component->ResolveHooks();
 		std::string key = "r" + std::to_string(ComponentDB::runtimeAddCount);
 		ComponentDB::runtimeAddCount++;
 		temp->key = key;
 		temp->actor = actor;
+		component->keyId = ComponentDB::InternKey(key);
 
 		actor->keyedComponents.insert(std::pair(key, component));
 		actor->typedComponents[temp->type].push_back(component);
 		ComponentInsertSort(actor->typedComponents[temp->type]);
-
-		actor->startingComponents.push_back(component);
-		ComponentInsertSort(actor->startingComponents);
-		actor->updatingComponents.push_back(component);
-		ComponentInsertSort(actor->updatingComponents);
+		HookTable::RegisterComponent(actor, component);
 
 		return component;
 	}
     else {
         return luabridge::LuaRef(ComponentDB::GetLuaState());
     }
-}
+}
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 #include "Actor.h"
+#include "Component.h"
+#include "CookedScene.h"
+#include "Profiler.h"
 
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -10,6 +16,13 @@
 #include "LuaBridge/LuaBridge.h"
 #include "rapidjson/document.h"
 
+/* The two metatables every instance of one parent shares, a component type or a template's component.
+   Both fall through to the parent; they differ only in the "enabled" their __index lookup holds. */
+struct SharedMetatables {
+	luabridge::LuaRef enabled;
+	luabridge::LuaRef disabled;
+};
+
 class ComponentDB {
 public:
 	static std::unordered_map<std::string, std::optional<luabridge::LuaRef>> componentCache;
@@ -19,18 +32,42 @@ public:
 	}
 	static void LuaInit();
 	static void ReportError(const std::string& actor_name, const luabridge::LuaException& e);
+	static void ReportError(const std::string& actor_name, const std::string& message);
+	static inline void TagScope(ProfileScope& scope, Actor* actor, const luabridge::LuaRef& component) {
+		if (Profiler::enabled) {
+			scope.Tag(actor->GetName(), component["type"].tostring());
+		}
+	}
 
-	static void ComponentInsertSort(std::vector<std::shared_ptr<luabridge::LuaRef>>& components);
+	static uint32_t InternKey(const std::string& key);
+	static inline uint32_t KeyRank(uint32_t key_id) {
+		return ComponentDB::keyRanks[key_id];
+	}
+	static void ComponentInsertSort(std::vector<std::shared_ptr<Component>>& components);
+	static luabridge::LuaRef LoadComponentType(const std::string& component);
 	static void LoadComponent(Actor* actor, const std::string& component, const std::string& key,
 		rapidjson::GenericMemberIterator<false, rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>> value);
+	static void LoadCookedComponent(Actor* actor, const CookedFile& file, const CookedComponent& cooked);
+	static void LoadCookedOverrides(luabridge::LuaRef component, const CookedFile& file, const CookedComponent& cooked);
 	static void LoadSystemComponent(Actor* actor, const std::string& component, const std::string& key);
-	static void EstablishInheritance(luabridge::LuaRef& instanceTable, luabridge::LuaRef& parentTable);
+	// An empty instance of parentTable, with room for field_count fields before it has to grow.
+	static std::shared_ptr<Component> NewInstance(const luabridge::LuaRef& parentTable, bool enabled, int field_count);
 	static void LoadOverride(luabridge::LuaRef component,
 		rapidjson::GenericMemberIterator<false, rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>> value);
 	static void ComponentCopy(Actor* actor, Actor* templateActor);
-	static std::shared_ptr<luabridge::LuaRef> RuntimeComponentLoad(Actor* actor, const std::string& component);
+	static void ComponentReset(Actor* actor, Actor* templateActor);
+	static std::shared_ptr<Component> RuntimeComponentLoad(Actor* actor, const std::string& component);
 private:
 	static lua_State* lua_state;
+	static inline std::unordered_map<const void*, SharedMetatables> sharedMetatables; // By parent table; they keep it alive
+	static const SharedMetatables& MetatablesFor(const luabridge::LuaRef& parentTable);
+	static std::shared_ptr<Component> NewComponent(Actor* actor, const std::string& component, const std::string& key,
+		int override_count);
+	static std::shared_ptr<Component> NewScriptInstance(const std::string& component, const std::string& key, int override_count);
+	static void AttachComponent(Actor* actor, std::shared_ptr<Component>& instance, const std::string& component,
+		const std::string& key);
 	static int runtimeAddCount;
+	static std::map<std::string, uint32_t> keyIds; // Ordered, so a new key can find its neighbours
+	static std::vector<uint32_t> keyRanks;
 	ComponentDB();
 };
\ No newline at end of file
@@ -0,0 +1,475 @@
+#include "CookedScene.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "rapidjson/filereadstream.h"
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+const uint32_t COOKED_MAGIC = 0x4B4F4F43; // "COOK"
+const uint32_t COOKED_VERSION = 1;
+
+bool StatDependency(const std::string& path, int64_t& mtime, uint64_t& size) {
+	std::error_code error;
+	auto write_time = std::filesystem::last_write_time(path, error);
+	if (error) {
+		return false;
+	}
+	auto bytes = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+	size = static_cast<uint64_t>(bytes);
+	return true;
+}
+
+template <class T>
+bool SectionFits(uint64_t offset, uint64_t count, size_t file_bytes) {
+	return offset % alignof(T) == 0 && offset <= file_bytes && count <= (file_bytes - offset) / sizeof(T);
+}
+
+CookedFile::~CookedFile() {
+	Close();
+}
+
+bool CookedFile::Map(const std::string& path) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER bytes;
+	if (!GetFileSizeEx(file, &bytes) || bytes.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (file_mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+	const void* view = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(file_mapping);
+		CloseHandle(file);
+		return false;
+	}
+	this->fileHandle = file;
+	this->mappingHandle = file_mapping;
+	this->mapping = view;
+	this->mappedBytes = static_cast<size_t>(bytes.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // The mapping keeps the file alive
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	this->mapping = view;
+	this->mappedBytes = static_cast<size_t>(info.st_size);
+#endif
+	return true;
+}
+
+void CookedFile::Close() {
+	if (this->mapping != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(this->mapping);
+		CloseHandle(static_cast<HANDLE>(this->mappingHandle));
+		CloseHandle(static_cast<HANDLE>(this->fileHandle));
+		this->mappingHandle = nullptr;
+		this->fileHandle = nullptr;
+#else
+		munmap(const_cast<void*>(this->mapping), this->mappedBytes);
+#endif
+	}
+	this->mapping = nullptr;
+	this->mappedBytes = 0;
+	this->header = nullptr;
+}
+
+bool CookedFile::Open(const std::string& path, COOKED_KIND kind) {
+	Close();
+	if (!Map(path)) {
+		return false;
+	}
+
+	const char* base = static_cast<const char*>(this->mapping);
+	this->header = reinterpret_cast<const CookedHeader*>(base);
+	if (this->mappedBytes < sizeof(CookedHeader) || !Validate(kind)) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool CookedFile::Validate(COOKED_KIND kind) {
+	const CookedHeader& h = *this->header;
+	size_t bytes = this->mappedBytes;
+	if (h.magic != COOKED_MAGIC || h.version != COOKED_VERSION || h.kind != kind) {
+		return false;
+	}
+	if (!SectionFits<uint32_t>(h.stringOffsets, h.stringCount, bytes) || !SectionFits<char>(h.stringData, h.stringBytes, bytes)
+		|| !SectionFits<CookedDependency>(h.dependencies, h.dependencyCount, bytes)
+		|| !SectionFits<CookedActor>(h.actors, h.actorCount, bytes)
+		|| !SectionFits<CookedComponent>(h.components, h.componentCount, bytes)
+		|| !SectionFits<CookedOverride>(h.overrides, h.overrideCount, bytes)) {
+		return false;
+	}
+
+	// Everything is checked here once, so loading can index the arrays without further tests.
+	const char* base = static_cast<const char*>(this->mapping);
+	this->stringOffsets = reinterpret_cast<const uint32_t*>(base + h.stringOffsets);
+	this->stringData = base + h.stringData;
+	this->actors = reinterpret_cast<const CookedActor*>(base + h.actors);
+	this->components = reinterpret_cast<const CookedComponent*>(base + h.components);
+	this->overrides = reinterpret_cast<const CookedOverride*>(base + h.overrides);
+
+	if (h.stringCount > 0 && (h.stringBytes == 0 || this->stringData[h.stringBytes - 1] != '\0')) {
+		return false;
+	}
+	for (uint32_t i = 0; i < h.stringCount; i++) {
+		if (this->stringOffsets[i] >= h.stringBytes) {
+			return false;
+		}
+	}
+	auto string_ok = [&h](uint32_t index, bool optional) {
+		return index < h.stringCount || (optional && index == COOKED_NONE);
+	};
+	for (uint32_t i = 0; i < h.actorCount; i++) {
+		const CookedActor& actor = this->actors[i];
+		if (!string_ok(actor.templateName, true) || !string_ok(actor.name, true)
+			|| actor.firstComponent > h.componentCount || actor.componentCount > h.componentCount - actor.firstComponent) {
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < h.componentCount; i++) {
+		const CookedComponent& component = this->components[i];
+		if (!string_ok(component.key, false) || !string_ok(component.type, true)
+			|| component.firstOverride > h.overrideCount || component.overrideCount > h.overrideCount - component.firstOverride) {
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < h.overrideCount; i++) {
+		const CookedOverride& value = this->overrides[i];
+		if (!string_ok(value.field, false) || value.kind > COOKED_BOOL || (value.kind == COOKED_STRING && !string_ok(value.value.s, false))) {
+			return false;
+		}
+	}
+
+	const CookedDependency* dependencies = reinterpret_cast<const CookedDependency*>(base + h.dependencies);
+	for (uint32_t i = 0; i < h.dependencyCount; i++) {
+		int64_t mtime = 0;
+		uint64_t size = 0;
+		if (!string_ok(dependencies[i].path, false)
+			|| !StatDependency(CookedScene::resourcesDirectory + "/" + String(dependencies[i].path), mtime, size)
+			|| mtime != dependencies[i].mtime || size != dependencies[i].size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Builds one cooked file in memory. */
+class CookWriter {
+public:
+	uint32_t Intern(const std::string& value) {
+		auto it = this->ids.find(value);
+		if (it != this->ids.end()) {
+			return it->second;
+		}
+		uint32_t id = static_cast<uint32_t>(this->strings.size());
+		this->strings.push_back(value);
+		this->ids.emplace(value, id);
+		return id;
+	}
+
+	bool AddDependency(const std::string& relative_path) {
+		CookedDependency dependency;
+		if (!StatDependency(CookedScene::resourcesDirectory + "/" + relative_path, dependency.mtime, dependency.size)) {
+			return false;
+		}
+		dependency.path = Intern(relative_path);
+		this->dependencies.push_back(dependency);
+		return true;
+	}
+
+	// The same conversions ComponentDB::LoadOverride makes, decided once here instead of at every load.
+	void AddComponent(CookedActor& actor, const std::string& key, uint32_t type, const rapidjson::Value& fields) {
+		CookedComponent component;
+		component.key = Intern(key);
+		component.type = type;
+		component.firstOverride = static_cast<uint32_t>(this->overrides.size());
+		for (auto itr = fields.MemberBegin(); itr != fields.MemberEnd(); ++itr) {
+			if (std::string(itr->name.GetString()) == "type") {
+				continue;
+			}
+			CookedOverride value;
+			value.field = Intern(itr->name.GetString());
+			if (itr->value.IsInt()) {
+				value.kind = COOKED_INT;
+				value.value.i = itr->value.GetInt();
+			}
+			else if (itr->value.IsFloat()) {
+				value.kind = COOKED_FLOAT;
+				value.value.f = itr->value.GetFloat();
+			}
+			else if (itr->value.IsString()) {
+				value.kind = COOKED_STRING;
+				value.value.s = Intern(itr->value.GetString());
+			}
+			else if (itr->value.IsBool()) {
+				value.kind = COOKED_BOOL;
+				value.value.b = itr->value.GetBool() ? 1 : 0;
+			}
+			else {
+				continue;
+			}
+			this->overrides.push_back(value);
+		}
+		component.overrideCount = static_cast<uint32_t>(this->overrides.size()) - component.firstOverride;
+		this->components.push_back(component);
+		actor.componentCount++;
+	}
+
+	CookedActor& BeginActor() {
+		CookedActor actor;
+		actor.firstComponent = static_cast<uint32_t>(this->components.size());
+		this->actors.push_back(actor);
+		return this->actors.back();
+	}
+
+	bool Write(const std::string& path, COOKED_KIND kind) {
+		CookedHeader header;
+		header.magic = COOKED_MAGIC;
+		header.version = COOKED_VERSION;
+		header.kind = kind;
+		header.stringCount = static_cast<uint32_t>(this->strings.size());
+		header.dependencyCount = static_cast<uint32_t>(this->dependencies.size());
+		header.actorCount = static_cast<uint32_t>(this->actors.size());
+		header.componentCount = static_cast<uint32_t>(this->components.size());
+		header.overrideCount = static_cast<uint32_t>(this->overrides.size());
+
+		std::vector<uint32_t> offsets;
+		std::string data;
+		for (auto& value : this->strings) {
+			offsets.push_back(static_cast<uint32_t>(data.size()));
+			data.append(value);
+			data.push_back('\0');
+		}
+
+		std::string out(sizeof(CookedHeader), '\0');
+		auto section = [&out](const void* bytes, size_t count) {
+			out.resize((out.size() + 7) & ~size_t(7), '\0');
+			uint64_t offset = out.size();
+			out.append(static_cast<const char*>(bytes), count);
+			return offset;
+		};
+		header.stringOffsets = section(offsets.data(), offsets.size() * sizeof(uint32_t));
+		header.stringData = section(data.data(), data.size());
+		header.stringBytes = data.size();
+		header.dependencies = section(this->dependencies.data(), this->dependencies.size() * sizeof(CookedDependency));
+		header.actors = section(this->actors.data(), this->actors.size() * sizeof(CookedActor));
+		header.components = section(this->components.data(), this->components.size() * sizeof(CookedComponent));
+		header.overrides = section(this->overrides.data(), this->overrides.size() * sizeof(CookedOverride));
+		std::memcpy(&out[0], &header, sizeof(CookedHeader));
+
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+		// Written aside and renamed, so a running game never maps a half-written file.
+		std::string temp_path = path + ".tmp";
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				return false;
+			}
+			file.write(out.data(), static_cast<std::streamsize>(out.size()));
+			if (!file.good()) {
+				return false;
+			}
+		}
+		std::filesystem::rename(temp_path, path, error);
+		return !error;
+	}
+private:
+	std::vector<std::string> strings;
+	std::unordered_map<std::string, uint32_t> ids;
+	std::vector<CookedDependency> dependencies;
+	std::vector<CookedActor> actors;
+	std::vector<CookedComponent> components;
+	std::vector<CookedOverride> overrides;
+};
+
+bool ReadCookSource(const std::string& path, rapidjson::Document& document) {
+	FILE* file_pointer = nullptr;
+#ifdef _WIN32
+	fopen_s(&file_pointer, path.c_str(), "rb");
+#else
+	file_pointer = fopen(path.c_str(), "rb");
+#endif
+	if (file_pointer == nullptr) {
+		std::cout << "error: cannot open " << path << std::endl;
+		return false;
+	}
+	char buffer[65536];
+	rapidjson::FileReadStream stream(file_pointer, buffer, sizeof(buffer));
+	document.ParseStream(stream);
+	std::fclose(file_pointer);
+	if (document.HasParseError() || !document.IsObject()) {
+		std::cout << "error parsing json at [" << path << "]" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+std::string CookedScene::ScenePath(const std::string& sceneName) {
+	return CookedScene::resourcesDirectory + "/cooked/scenes/" + sceneName + ".scene.bin";
+}
+
+std::string CookedScene::TemplatePath(const std::string& templateName) {
+	return CookedScene::resourcesDirectory + "/cooked/actor_templates/" + templateName + ".template.bin";
+}
+
+bool CookedScene::CookTemplate(const std::string& templateName) {
+	std::string source = "actor_templates/" + templateName + ".template";
+	rapidjson::Document templateJson;
+	CookWriter writer;
+	if (!ReadCookSource(CookedScene::resourcesDirectory + "/" + source, templateJson) || !writer.AddDependency(source)) {
+		return false;
+	}
+
+	CookedActor& actor = writer.BeginActor();
+	if (templateJson.HasMember("name") && templateJson["name"].IsString()) {
+		actor.name = writer.Intern(templateJson["name"].GetString());
+	}
+	if (templateJson.HasMember("components") && templateJson["components"].IsObject()) {
+		for (auto itr = templateJson["components"].MemberBegin(); itr != templateJson["components"].MemberEnd(); ++itr) {
+			if (itr->value.IsObject() && itr->value.HasMember("type") && itr->value["type"].IsString()) {
+				writer.AddComponent(actor, itr->name.GetString(), writer.Intern(itr->value["type"].GetString()), itr->value);
+			}
+		}
+	}
+	return writer.Write(CookedScene::TemplatePath(templateName), COOKED_TEMPLATE);
+}
+
+bool CookedScene::CookScene(const std::string& sceneName) {
+	std::string source = "scenes/" + sceneName + ".scene";
+	rapidjson::Document sceneJson;
+	CookWriter writer;
+	if (!ReadCookSource(CookedScene::resourcesDirectory + "/" + source, sceneJson) || !writer.AddDependency(source)) {
+		return false;
+	}
+	if (!sceneJson.HasMember("actors") || !sceneJson["actors"].IsArray()) {
+		std::cout << "error: scene " << sceneName << " has no actors array" << std::endl;
+		return false;
+	}
+
+	// Which keys each template defines, so inheritance is settled here rather than by a lookup per component.
+	std::unordered_map<std::string, std::unordered_set<std::string>> templateKeys;
+	for (auto& actorJson : sceneJson["actors"].GetArray()) {
+		std::unordered_set<std::string> keys;
+		uint32_t templateName = COOKED_NONE;
+		if (actorJson.HasMember("template") && actorJson["template"].IsString()) {
+			std::string name = actorJson["template"].GetString();
+			auto found = templateKeys.find(name);
+			if (found == templateKeys.end()) {
+				std::string templateSource = "actor_templates/" + name + ".template";
+				rapidjson::Document templateJson;
+				if (!ReadCookSource(CookedScene::resourcesDirectory + "/" + templateSource, templateJson)
+					|| !writer.AddDependency(templateSource)) {
+					std::cout << "error: template " << name << " is missing" << std::endl;
+					return false;
+				}
+				std::unordered_set<std::string> defined;
+				if (templateJson.HasMember("components") && templateJson["components"].IsObject()) {
+					for (auto itr = templateJson["components"].MemberBegin(); itr != templateJson["components"].MemberEnd(); ++itr) {
+						if (itr->value.IsObject() && itr->value.HasMember("type")) {
+							defined.insert(itr->name.GetString());
+						}
+					}
+				}
+				found = templateKeys.emplace(name, std::move(defined)).first;
+			}
+			keys = found->second;
+			templateName = writer.Intern(name);
+		}
+
+		CookedActor& actor = writer.BeginActor();
+		actor.templateName = templateName;
+		if (actorJson.HasMember("name") && actorJson["name"].IsString()) {
+			actor.name = writer.Intern(actorJson["name"].GetString());
+		}
+		if (actorJson.HasMember("components") && actorJson["components"].IsObject()) {
+			for (auto itr = actorJson["components"].MemberBegin(); itr != actorJson["components"].MemberEnd(); ++itr) {
+				if (!itr->value.IsObject()) {
+					continue;
+				}
+				std::string key = itr->name.GetString();
+				if (keys.find(key) != keys.end()) {
+					writer.AddComponent(actor, key, COOKED_NONE, itr->value);
+				}
+				else if (itr->value.HasMember("type") && itr->value["type"].IsString()) {
+					writer.AddComponent(actor, key, writer.Intern(itr->value["type"].GetString()), itr->value);
+					keys.insert(key);
+				}
+			}
+		}
+	}
+	return writer.Write(CookedScene::ScenePath(sceneName), COOKED_SCENE);
+}
+
+int CookedScene::CookAll() {
+	int failed = 0;
+	int cooked = 0;
+	auto cook_directory = [&](const std::string& directory, const std::string& extension, bool (*cook)(const std::string&)) {
+		std::error_code error;
+		std::filesystem::directory_iterator it(CookedScene::resourcesDirectory + "/" + directory, error);
+		if (error) {
+			return;
+		}
+		for (auto& entry : it) {
+			if (entry.path().extension() != extension) {
+				continue;
+			}
+			if (cook(entry.path().stem().string())) {
+				cooked++;
+			}
+			else {
+				std::cout << "failed to cook " << entry.path().string() << std::endl;
+				failed++;
+			}
+		}
+	};
+	cook_directory("actor_templates", ".template", &CookedScene::CookTemplate);
+	cook_directory("scenes", ".scene", &CookedScene::CookScene);
+	std::cout << "cooked " << cooked << " files, " << failed << " failed" << std::endl;
+	return failed;
+}
\ No newline at end of file
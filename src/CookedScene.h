@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* On-disk layout of a cooked .scene or .template. Every section is a flat array at an 8-byte aligned offset,
+   so a mapped file is read in place. Strings are interned once into a table of NUL-terminated entries. */
+enum COOKED_KIND : uint32_t { COOKED_SCENE = 1, COOKED_TEMPLATE = 2 };
+enum COOKED_VALUE : uint32_t { COOKED_INT, COOKED_FLOAT, COOKED_STRING, COOKED_BOOL };
+
+const uint32_t COOKED_NONE = 0xFFFFFFFFu; // An absent string
+
+struct CookedHeader {
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t kind = 0;
+	uint32_t stringCount = 0;
+	uint32_t dependencyCount = 0;
+	uint32_t actorCount = 0;
+	uint32_t componentCount = 0;
+	uint32_t overrideCount = 0;
+	uint64_t stringOffsets = 0; // uint32_t[stringCount], relative to stringData
+	uint64_t stringData = 0;
+	uint64_t stringBytes = 0;
+	uint64_t dependencies = 0;
+	uint64_t actors = 0;
+	uint64_t components = 0;
+	uint64_t overrides = 0;
+};
+
+/* A source file the cooked one was built from; it is stale once any of them changes. */
+struct CookedDependency {
+	uint32_t path = 0;
+	uint32_t padding = 0;
+	int64_t mtime = 0;
+	uint64_t size = 0;
+};
+
+struct CookedActor {
+	uint32_t templateName = COOKED_NONE;
+	uint32_t name = COOKED_NONE;
+	uint32_t firstComponent = 0;
+	uint32_t componentCount = 0;
+};
+
+/* type is COOKED_NONE when the cooker found key among the template's components, so the overrides
+   apply to the inherited component instead of creating one. */
+struct CookedComponent {
+	uint32_t key = 0;
+	uint32_t type = COOKED_NONE;
+	uint32_t firstOverride = 0;
+	uint32_t overrideCount = 0;
+};
+
+struct CookedOverride {
+	uint32_t field = 0;
+	uint32_t kind = COOKED_INT;
+	union {
+		int32_t i;
+		float f;
+		uint32_t s;
+		uint32_t b;
+	} value = { 0 };
+};
+
+/* A read-only mapping of one cooked file, checked once when it is opened. */
+class CookedFile {
+public:
+	CookedFile() {}
+	~CookedFile();
+	CookedFile(const CookedFile&) = delete;
+	CookedFile& operator=(const CookedFile&) = delete;
+
+	bool Open(const std::string& path, COOKED_KIND kind); // False if missing, corrupt or stale
+	void Close();
+	bool IsOpen() const {
+		return header != nullptr;
+	}
+
+	const char* String(uint32_t index) const {
+		return stringData + stringOffsets[index];
+	}
+	uint32_t ActorCount() const {
+		return header->actorCount;
+	}
+	uint32_t StringCount() const {
+		return header->stringCount;
+	}
+	const CookedActor& ActorAt(uint32_t index) const {
+		return actors[index];
+	}
+	const CookedComponent& ComponentAt(uint32_t index) const {
+		return components[index];
+	}
+	const CookedOverride& OverrideAt(uint32_t index) const {
+		return overrides[index];
+	}
+private:
+	const CookedHeader* header = nullptr;
+	const uint32_t* stringOffsets = nullptr;
+	const char* stringData = nullptr;
+	const CookedActor* actors = nullptr;
+	const CookedComponent* components = nullptr;
+	const CookedOverride* overrides = nullptr;
+	const void* mapping = nullptr;
+	size_t mappedBytes = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+	bool Map(const std::string& path);
+	bool Validate(COOKED_KIND kind);
+};
+
+/* Paths of cooked files, and the cook step itself (the scene_cook tool). Dependencies are recorded
+   relative to resourcesDirectory, so a cooked tree stays valid wherever the game runs from. */
+class CookedScene {
+public:
+	static inline std::string resourcesDirectory = "resources";
+
+	static std::string ScenePath(const std::string& sceneName);
+	static std::string TemplatePath(const std::string& templateName);
+	static int CookAll(); // Returns how many files failed
+	static bool CookTemplate(const std::string& templateName);
+	static bool CookScene(const std::string& sceneName);
+private:
+	CookedScene() {}
+};
\ No newline at end of file
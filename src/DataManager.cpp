@@ -1,7 +1,9 @@
 #include "Actor.h"
+#include "ActorStore.h"
 #include "ComponentDB.h"
 #include "DataManager.h"
 #include "EngineUtils.h"
+#include "HookTable.h"
 #include "SceneDB.h"
 
 #include <charconv>
@@ -136,7 +138,13 @@ void SetComponentSave(Actor* actor, rapidjson::Value& component_save, rapidjson:
 		auto& comp = kval.second;
 		rapidjson::Value key(kval.first.c_str(), alloc);
 		rapidjson::Value value;
-		value.SetString(serializeTable(*comp).c_str(), alloc);
+		std::string serial = serializeTable(*comp);
+		if (comp->isTable()) {
+			// "enabled" lives behind the instance metatable, so serializeTable never sees it
+			std::string enabled = std::string("[\"enabled\"]=") + (comp->IsEnabled() ? "true" : "false");
+			serial.insert(1, serial.size() > 2 ? enabled + "," : enabled);
+		}
+		value.SetString(serial.c_str(), alloc);
 		component_save.AddMember(key, value, alloc);
 	}
 }
@@ -521,6 +529,7 @@ void DataManager::LoadSystem() {
 				}
 				else {
 					Actor* tempActor = new Actor();
+					ActorStore::Insert(tempActor);
 					tempActor->SetName(itr->name.GetString());
 					tempActor->SetID(id);
 
@@ -540,17 +549,8 @@ void DataManager::LoadSystem() {
 						}
 					}
 
-					SceneDB::actors.push_back(tempActor);
 					SceneDB::namedActors[(*tempActor).GetName()].push_back(tempActor);
-					if (!(*tempActor).startingComponents.empty()) {
-						SceneDB::startingActors.push_back(tempActor);
-					}
-					if (!(*tempActor).updatingComponents.empty()) {
-						SceneDB::updatingActors.push_back(tempActor);
-					}
-					if (!(*tempActor).lateUpdatingComponents.empty()) {
-						SceneDB::lateUpdatingActors.push_back(tempActor);
-					}
+					HookTable::RegisterActor(tempActor);
 
 					tempActor->SystemSave();
 				}
@@ -589,6 +589,7 @@ void DataManager::LoadSystem() {
 				}
 				else {
 					Actor* tempActor = new Actor();
+					ActorStore::Insert(tempActor);
 					tempActor->SetName(itr->name.GetString());
 					tempActor->SetID(id);
 
@@ -608,17 +609,8 @@ void DataManager::LoadSystem() {
 						}
 					}
 
-					SceneDB::actors.push_back(tempActor);
 					SceneDB::namedActors[(*tempActor).GetName()].push_back(tempActor);
-					if (!(*tempActor).startingComponents.empty()) {
-						SceneDB::startingActors.push_back(tempActor);
-					}
-					if (!(*tempActor).updatingComponents.empty()) {
-						SceneDB::updatingActors.push_back(tempActor);
-					}
-					if (!(*tempActor).lateUpdatingComponents.empty()) {
-						SceneDB::lateUpdatingActors.push_back(tempActor);
-					}
+					HookTable::RegisterActor(tempActor);
 
 					tempActor->SystemSave();
 				}
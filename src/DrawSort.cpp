@@ -0,0 +1,36 @@
+#include "DrawSort.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+void DrawSort::Sort() {
+	size_t count = this->keys.size();
+	this->scratch.resize(count);
+
+	for (int shift = 32; shift < 64; shift += 8) {
+		size_t buckets[256] = {};
+		for (uint64_t key : this->keys) {
+			buckets[(key >> shift) & 0xFF]++;
+		}
+		if (count == 0 || buckets[(this->keys[0] >> shift) & 0xFF] == count) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (auto& bucket : buckets) {
+			size_t size = bucket;
+			bucket = offset;
+			offset += size;
+		}
+		for (uint64_t key : this->keys) {
+			this->scratch[buckets[(key >> shift) & 0xFF]++] = key;
+		}
+		this->keys.swap(this->scratch);
+	}
+
+	this->order.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		this->order[i] = static_cast<uint32_t>(this->keys[i]);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Orders a frame's draw commands by sorting_order, ties kept in submission order, without allocating once
+   its buffers have grown to the frame's size. Each command becomes a 64-bit key, sorting_order (biased to
+   sort unsigned) over submission index, and a stable LSD radix sort runs over the sorting_order bytes only:
+   the index half is ascending already. Bytes every command shares are skipped, so the usual handful of
+   small sorting orders costs one or two passes. */
+class DrawSort {
+public:
+	template <typename Command>
+	const std::vector<uint32_t>& Order(const std::vector<Command>& commands) {
+		this->keys.resize(commands.size());
+		for (size_t i = 0; i < commands.size(); i++) {
+			this->keys[i] = DrawSort::Key(commands[i].sorting_order, static_cast<uint32_t>(i));
+		}
+		this->Sort();
+		return this->order;
+	}
+private:
+	std::vector<uint64_t> keys;
+	std::vector<uint64_t> scratch;
+	std::vector<uint32_t> order;
+
+	static uint64_t Key(int sorting_order, uint32_t index) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(sorting_order) ^ 0x80000000u) << 32) | index;
+	}
+	void Sort();
+};
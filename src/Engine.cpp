@@ -1,13 +1,28 @@
+#include "BatchDispatch.h"
+#include "Benchmark.h"
 #include "ComponentDB.h"
 #include "DataManager.h"
 #include "Engine.h"
 #include "EngineUtils.h"
+#include "HookTable.h"
 #include "InputManager.h"
+#include "JobSystem.h"
+#include "LuaAllocator.h"
+#include "LuaHeap.h"
+#include "Profiler.h"
 #include "Renderer.h"
+#include "Rigidbody.h"
 #include "SceneDB.h"
+#include "SceneLoader.h"
+#include "ScriptCache.h"
+#include "SpatialIndex.h"
+#include "Time.h"
+#include "UpdateScheduler.h"
+#include "WorldStreamer.h"
 
 #include "AudioHelper.h"
 
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 
@@ -20,11 +35,28 @@
 
 bool Engine::running = true;
 
+bool IsEnvSet(const char* name) {
+#ifdef _WIN32
+	char* val = nullptr;
+	size_t length = 0;
+	_dupenv_s(&val, &length, name);
+	if (val) {
+		free(val);
+		return true;
+	}
+	return false;
+#else
+	return std::getenv(name) != nullptr;
+#endif
+}
+
 void Engine::GameLoop()
 {
 	rapidjson::Document configJson;
 	rapidjson::Document renderingJson;
 
+	Profiler::Init();
+
 	if (!std::filesystem::exists("resources")) {
 		std::cout << "error: resources/ missing";
 		std::exit(0);
@@ -34,6 +66,10 @@ void Engine::GameLoop()
 		std::exit(0);
 	}
 
+	if (Benchmark::headless) {
+		Benchmark::ConfigureHeadlessDrivers();
+	}
+
 	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
 		std::cout << "SDL could not initialize! SDL Error: " << SDL_GetError() << std::endl;
 		return;
@@ -65,8 +101,33 @@ void Engine::GameLoop()
 		return;
 	}
 
-	SDL_Renderer* renderer = Helper::SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
+	if (Benchmark::headless) {
+		Helper::frame_rate_cap = 0;
+		Time::lockstep = true;
+	}
+
+	Uint32 rendererFlags = SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED;
+	if (Benchmark::headless) {
+		rendererFlags = SDL_RENDERER_SOFTWARE;
+	}
+
+	if (IsEnvSet("AUTOGRADER") || IsEnvSet("RENDERLOGGER") || std::filesystem::exists(Helper::USER_INPUT_FILENAME)) {
+		// Replays and render logs key off frame_number, which must advance in lockstep with the scripts.
+		Renderer::threaded = false;
+	}
+#ifdef __APPLE__
+	// Cocoa only lets the main thread create a renderer and present, so threaded_rendering is ignored on macOS.
+	Renderer::threaded = false;
+#endif
+	Renderer::StartRenderThread();
+
+	// The render thread owns the renderer for its whole lifetime, so it has to be the one to create it.
+	SDL_Renderer* renderer = nullptr;
+	Renderer::RunOnRenderThread([window, rendererFlags, &renderer]() {
+		renderer = Helper::SDL_CreateRenderer(window, -1, rendererFlags);
+	});
 	if (renderer == nullptr) {
+		Renderer::StopRenderThread();
 		SDL_DestroyWindow(window);
 		SDL_Quit();
 		return;
@@ -75,44 +136,47 @@ void Engine::GameLoop()
 	Renderer::renderer_ptr = renderer;
 
 	if (IMG_Init(IMG_INIT_PNG) == -1) {
+		Renderer::StopRenderThread();
 		SDL_DestroyWindow(window);
 		SDL_Quit();
 		return;
 	}
 
+	JobSystem::Init();
+	if (ScriptCache::precompile) {
+		ScriptCache::PrecompileAll("resources/component_types");
+	}
 	ComponentDB::LuaInit();
 
 	SceneDB::LoadScene(SceneDB::nextScene);
 
-	SDL_RenderSetScale(Renderer::renderer_ptr, Renderer::RENDER_SCALE, Renderer::RENDER_SCALE);
-	SDL_SetRenderDrawColor(Renderer::renderer_ptr, Renderer::CLEAR_COLOR.r,
-		Renderer::CLEAR_COLOR.g, Renderer::CLEAR_COLOR.b, SDL_ALPHA_OPAQUE);
-	SDL_RenderClear(Renderer::renderer_ptr);
+	Renderer::RunOnRenderThread([]() {
+		SDL_RenderSetScale(Renderer::renderer_ptr, Renderer::RENDER_SCALE, Renderer::RENDER_SCALE);
+		SDL_SetRenderDrawColor(Renderer::renderer_ptr, Renderer::CLEAR_COLOR.r,
+			Renderer::CLEAR_COLOR.g, Renderer::CLEAR_COLOR.b, SDL_ALPHA_OPAQUE);
+		SDL_RenderClear(Renderer::renderer_ptr);
+	});
 
+	Time::Init();
 	while (Engine::running)
 	{
-		if (SceneDB::nextScene != "") {
-			SceneDB::LoadScene(SceneDB::nextScene);
+		if (Benchmark::headless) {
+			Benchmark::BeginFrame();
 		}
 
-		Engine::OnStart();
-		SDL_Event nextEvent;
-		while (Helper::SDL_PollEvent(&nextEvent)) {
-			Input::ProcessEvent(nextEvent);
-			if (nextEvent.type == SDL_QUIT) {
-				Engine::running = false;
-			}
-		}
+		Engine::RunFrame();
 
-		Engine::OnUpdate();
-		Engine::OnLateUpdate();
-		SceneDB::AddComponents();
-		SceneDB::RemoveComponents();
+		if (Benchmark::headless && !Benchmark::EndFrame()) {
+			Engine::running = false;
+		}
+	}
 
-		SceneDB::AddActors();
-		SceneDB::RemoveActors();
+	Renderer::StopRenderThread();
+	SceneLoader::Shutdown();
+	JobSystem::Shutdown();
 
-		Renderer::RenderRenderer();
+	if (Benchmark::headless) {
+		Benchmark::Report();
 	}
 
 	std::filesystem::remove_all("saves/temp");
@@ -133,56 +197,142 @@ void Engine::GameLoop()
 	}
 }
 
-void Engine::OnStart() {
-	for (auto actor : SceneDB::startingActors) {
-		for (auto& component : actor->startingComponents) {
-			try {
-				if ((*component)["enabled"].cast<bool>()) {
-					(*component)["OnStart"](*component);
-				}
+void Engine::RunFrame() {
+	PROFILE_SCOPE("Frame");
+	if (SceneDB::nextScene != "") {
+		PROFILE_SCOPE("LoadScene");
+		SceneLoader::Cancel();
+		SceneDB::LoadScene(SceneDB::nextScene);
+	}
+	if (!SceneDB::pendingAdditive.empty()) {
+		PROFILE_SCOPE("LoadAdditive");
+		SceneDB::LoadPendingAdditive();
+	}
+	WorldStreamer::Update();
+	if (SceneLoader::IsBusy()) {
+		PROFILE_SCOPE("LoadSceneAsync");
+		SceneLoader::Update();
+	}
+
+	Time::BeginFrame();
+	JobSystem::DrainMainThreadQueue();
+
+	Engine::OnStart();
+	{
+		PROFILE_SCOPE("PollEvents");
+		SDL_Event nextEvent;
+		while (Helper::SDL_PollEvent(&nextEvent)) {
+			Input::ProcessEvent(nextEvent);
+			if (nextEvent.type == SDL_QUIT) {
+				Engine::running = false;
 			}
-			catch (const luabridge::LuaException& e) {
-				ComponentDB::ReportError(actor->GetName(), e);
+		}
+	}
+
+	UpdateScheduler::BeginFrame();
+	UpdateScheduler::DispatchVisibility();
+	Engine::OnUpdate();
+	Engine::OnLateUpdate();
+	{
+		PROFILE_SCOPE("AddComponents");
+		SceneDB::AddComponents();
+	}
+	{
+		PROFILE_SCOPE("RemoveComponents");
+		SceneDB::RemoveComponents();
+	}
+
+	{
+		PROFILE_SCOPE("AddActors");
+		SceneDB::AddActors();
+	}
+	{
+		PROFILE_SCOPE("RemoveActors");
+		SceneDB::RemoveActors();
+	}
+
+	{
+		PROFILE_SCOPE("Render");
+		Renderer::RenderRenderer();
+	}
+
+	// The frame is handed off (or presented), so this is the slot where a GC step hurts least.
+	LuaHeap::Step(ComponentDB::GetLuaState());
+	LuaAllocator::EndFrame();
+}
+
+void Engine::OnStart() {
+	PROFILE_SCOPE("OnStartPhase");
+	for (auto& entry : HookTable::Entries(HOOK_START)) {
+		ProfileScope scope("OnStart");
+		ComponentDB::TagScope(scope, entry.actor, *entry.component);
+		try {
+			if (entry.component->IsEnabled()) {
+				entry.component->Invoke(HOOK_START);
 			}
 		}
-		actor->startingComponents.clear();
+		catch (const luabridge::LuaException& e) {
+			ComponentDB::ReportError(entry.actor->GetName(), e);
+		}
 	}
-	SceneDB::startingActors.clear();
+	HookTable::Consume(HOOK_START);
 }
 
 void Engine::OnUpdate() {
-	for (auto actor : SceneDB::updatingActors) {
-		for (auto& component : actor->updatingComponents) {
-			try {
-				if ((*component)["enabled"].cast<bool>()) {
-					(*component)["OnUpdate"](*component);
-				}
-			}
-			catch (const luabridge::LuaException& e) {
-				ComponentDB::ReportError(actor->GetName(), e);
+	PROFILE_SCOPE("OnUpdatePhase");
+	if (BatchDispatch::enabled) {
+		BatchDispatch::Dispatch(BatchDispatch::update, HookTable::Entries(HOOK_UPDATE));
+		return;
+	}
+
+	for (auto& entry : HookTable::Entries(HOOK_UPDATE)) {
+		if (!UpdateScheduler::IsDue(entry.actor, *entry.component)) {
+			continue;
+		}
+		ProfileScope scope("OnUpdate");
+		ComponentDB::TagScope(scope, entry.actor, *entry.component);
+		try {
+			if (entry.component->IsEnabled()) {
+				entry.component->Invoke(HOOK_UPDATE);
 			}
 		}
+		catch (const luabridge::LuaException& e) {
+			ComponentDB::ReportError(entry.actor->GetName(), e);
+		}
 	}
 }
 
 void Engine::OnLateUpdate() {
+	PROFILE_SCOPE("OnLateUpdatePhase");
 	Input::LateUpdate();
 	
-	for (auto actor : SceneDB::lateUpdatingActors) {
-		for (auto& component : actor->lateUpdatingComponents) {
+	if (BatchDispatch::enabled) {
+		BatchDispatch::Dispatch(BatchDispatch::lateUpdate, HookTable::Entries(HOOK_LATE_UPDATE));
+	}
+	else {
+		for (auto& entry : HookTable::Entries(HOOK_LATE_UPDATE)) {
+			if (!UpdateScheduler::IsDue(entry.actor, *entry.component)) {
+				continue;
+			}
+			ProfileScope scope("OnLateUpdate");
+			ComponentDB::TagScope(scope, entry.actor, *entry.component);
 			try {
-				if ((*component)["enabled"].cast<bool>()) {
-					(*component)["OnLateUpdate"](*component);
+				if (entry.component->IsEnabled()) {
+					entry.component->Invoke(HOOK_LATE_UPDATE);
 				}
 			}
 			catch (const luabridge::LuaException& e) {
-				ComponentDB::ReportError(actor->GetName(), e);
+				ComponentDB::ReportError(entry.actor->GetName(), e);
 			}
 		}
 	}
 
 	SceneDB::EventSubs();
 
-	SceneDB::world.Step(1.0f / 60.0f, 8, 3);
-}
-
+	while (Time::ConsumeFixedStep()) {
+		PROFILE_SCOPE("PhysicsStep");
+		Rigidbody::StorePreviousTransforms();
+		SceneDB::world.Step(Time::FIXED_DELTA_TIME, 8, 3);
+		SpatialIndex::Invalidate();
+	}
+}
\ No newline at end of file
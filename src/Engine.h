@@ -9,6 +9,7 @@ public:
 	static bool running;
 
 	static void GameLoop();
+	static void RunFrame();
 
 	static void OnStart();
 	static void OnUpdate();
@@ -1,8 +1,20 @@
 #ifndef ENGINEUTILS_H
 #define ENGINEUTILS_H
 
+#include "BatchDispatch.h"
+#include "LuaHeap.h"
 #include "Renderer.h"
+#include "SceneLoader.h"
+#include "ScriptCache.h"
+#include "SpatialIndex.h"
+#include "TextCache.h"
 #include "TextDB.h"
+#include "TextureAtlas.h"
+#include "Time.h"
+#include "UpdateScheduler.h"
+#include "WorldStreamer.h"
+
+#include "Helper.h"
 
 #include <filesystem>
 #include <iostream>
@@ -14,7 +26,8 @@
 #include "rapidjson/filereadstream.h"
 #include "SDL2_TTF/SDL_ttf.h"
 
-static void ReadJsonFile(const std::string& path, rapidjson::Document& out_document)
+// Parses without reporting anything, for the scene loader's worker thread, which must not exit the process.
+static bool ParseJsonFile(const std::string& path, rapidjson::Document& out_document)
 {
 	FILE* file_pointer = nullptr;
 #ifdef _WIN32
@@ -26,11 +39,19 @@ static void ReadJsonFile(const std::string& path, rapidjson::Document& out_docum
 	rapidjson::FileReadStream stream(file_pointer, buffer, sizeof(buffer));
 	out_document.ParseStream(stream);
 	std::fclose(file_pointer);
+	return !out_document.HasParseError();
+}
 
-	if (out_document.HasParseError()) {
-		rapidjson::ParseErrorCode errorCode = out_document.GetParseError();
-		std::cout << "error parsing json at [" << path << "]" << std::endl;
-		exit(0);
+static void ExitOnJsonError(const std::string& path)
+{
+	std::cout << "error parsing json at [" << path << "]" << std::endl;
+	exit(0);
+}
+
+static void ReadJsonFile(const std::string& path, rapidjson::Document& out_document)
+{
+	if (!ParseJsonFile(path, out_document)) {
+		ExitOnJsonError(path);
 	}
 }
 
@@ -53,6 +74,54 @@ static void LoadGame(rapidjson::Document& configJson) {
 		Renderer::GAME_TITLE = configJson["game_title"].GetString();
 	}
 
+	if (configJson.HasMember("fixed_update_rate") && configJson["fixed_update_rate"].GetFloat() > 0.0f) {
+		Time::FIXED_DELTA_TIME = 1.0f / configJson["fixed_update_rate"].GetFloat();
+	}
+
+	if (configJson.HasMember("max_fixed_steps")) {
+		Time::MAX_FIXED_STEPS = std::max(configJson["max_fixed_steps"].GetInt(), 1);
+	}
+
+	if (configJson.HasMember("batched_dispatch")) {
+		BatchDispatch::enabled = configJson["batched_dispatch"].GetBool();
+	}
+
+	if (configJson.HasMember("bytecode_cache")) {
+		ScriptCache::enabled = configJson["bytecode_cache"].GetBool();
+	}
+
+	if (configJson.HasMember("precompile_scripts")) {
+		ScriptCache::precompile = configJson["precompile_scripts"].GetBool();
+	}
+
+	if (configJson.HasMember("lua_gc_mode")) {
+		std::string gc_mode = configJson["lua_gc_mode"].GetString();
+		if (!LuaHeap::ParseMode(gc_mode)) {
+			std::cout << "error: lua_gc_mode must be auto, incremental or generational, not " << gc_mode;
+			std::exit(0);
+		}
+	}
+
+	if (configJson.HasMember("lua_gc_budget_ms")) {
+		LuaHeap::stepBudgetMs = std::max(configJson["lua_gc_budget_ms"].GetDouble(), 0.0);
+	}
+
+	if (configJson.HasMember("spatial_cell_size") && configJson["spatial_cell_size"].GetFloat() > 0.0f) {
+		SpatialIndex::cellSize = configJson["spatial_cell_size"].GetFloat();
+	}
+
+	if (configJson.HasMember("scene_load_budget_ms")) {
+		SceneLoader::sliceBudgetMs = std::max(configJson["scene_load_budget_ms"].GetDouble(), 0.0);
+	}
+
+	if (configJson.HasMember("visible_margin")) {
+		UpdateScheduler::visibleMargin = std::max(configJson["visible_margin"].GetFloat(), 0.0f);
+	}
+
+	if (configJson.HasMember("stream_max_loads")) {
+		WorldStreamer::maxLoadsInFlight = std::max(configJson["stream_max_loads"].GetInt(), 1);
+	}
+
 	if (!configJson.HasMember("initial_scene")) {
 		std::cout << "error: initial_scene unspecified";
 		std::exit(0);
@@ -87,6 +156,47 @@ static void LoadRendering(rapidjson::Document& configJson) {
 		if (configJson.HasMember("zoom_factor")) {
 			Renderer::RENDER_SCALE = configJson["zoom_factor"].GetFloat();
 		}
+
+		if (configJson.HasMember("frame_rate_cap")) {
+			Helper::frame_rate_cap = configJson["frame_rate_cap"].GetInt();
+		}
+
+		if (configJson.HasMember("threaded_rendering")) {
+			Renderer::threaded = configJson["threaded_rendering"].GetBool();
+		}
+
+		if (configJson.HasMember("batched_sprites")) {
+			Renderer::batched = configJson["batched_sprites"].GetBool();
+		}
+
+		if (configJson.HasMember("frustum_culling")) {
+			ImageDB::culling = configJson["frustum_culling"].GetBool();
+		}
+
+		if (configJson.HasMember("cull_margin")) {
+			ImageDB::cullMargin = std::max(configJson["cull_margin"].GetFloat(), 0.0f);
+		}
+
+		if (configJson.HasMember("text_cache_size")) {
+			TextCache::capacity = static_cast<size_t>(std::max(configJson["text_cache_size"].GetInt(), 1));
+		}
+
+		if (configJson.HasMember("texture_atlas")) {
+			TextureAtlas::enabled = configJson["texture_atlas"].GetBool();
+		}
+
+		if (configJson.HasMember("atlas_page_size")) {
+			TextureAtlas::pageSize = std::max(configJson["atlas_page_size"].GetInt(), 64);
+		}
+
+		if (configJson.HasMember("atlas_groups")) {
+			for (auto& group : configJson["atlas_groups"].GetObject()) {
+				auto& images = TextureAtlas::sceneGroups[group.name.GetString()];
+				for (auto& image : group.value.GetArray()) {
+					images.push_back(image.GetString());
+				}
+			}
+		}
 	}
 }
 
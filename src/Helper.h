@@ -48,6 +48,7 @@ public:
 	/* The frame_number advances with every call to Helper::SDL_RenderPresent() */
 	static inline int frame_number = 0;
 	static inline Uint32 current_frame_start_timestamp = 0;
+	static inline int frame_rate_cap = 60; // 0 or less leaves pacing to vsync.
 	static int GetFrameNumber() { return frame_number; }
 
 	static SDL_Window* SDL_CreateWindow(const char* title, int x, int y, int w, int h, Uint32 flags)
@@ -226,6 +227,24 @@ public:
 		}
 	}
 
+	/* Batched images go out here, one call per run that shares a texture. The render logger notes each call and how many images it drew. */
+	static void SDL_RenderGeometry(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Vertex* vertices, int num_vertices, const int* indices, int num_indices)
+	{
+		::SDL_RenderGeometry(renderer, texture, vertices, num_vertices, indices, num_indices);
+
+		CheckForRenderLoggerInit();
+
+		if (render_logger_mode == RL_ENABLED)
+		{
+			float x_scale = 1;
+			float y_scale = 1;
+			SDL_RenderGetScale(renderer, &x_scale, &y_scale);
+
+			render_logging_file << GetFrameNumber() << ":geometry images " << num_indices / 6 << " vertices " << num_vertices
+				<< " renderscale " << x_scale << " " << y_scale << std::endl;
+		}
+	}
+
 	/* This encourages students to keep their data in float form as long as possible. We handle truncating to ints at the very end for them, as necessary. */
 	static void SDL_RenderCopy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_FRect* srcrect, const SDL_FRect* dstrect)
 	{
@@ -398,7 +417,7 @@ private:
 		return IsEnvVariableSet("RENDERLOGGER");
 	}
 
-	/* The engine will aim for 60fps (16ms per frame) during a normal play session. */
+	/* The engine will aim for frame_rate_cap fps (60fps / 16ms per frame by default) during a normal play session. */
 	/* If the engine detects it is being autograded, it will run as fast as possible. */
 	static void SDL_Delay() {
 
@@ -406,11 +425,11 @@ private:
 		{
 			//::SDL_Delay(1); Don't bother delaying at all. Gotta go fast when autograding.
 		}
-		else
+		else if (frame_rate_cap > 0)
 		{
 			Uint32 current_frame_end_timestamp = SDL_GetTicks();  // Record end time of the frame
 			Uint32 current_frame_duration_milliseconds = current_frame_end_timestamp - current_frame_start_timestamp;
-			Uint32 desired_frame_duration_milliseconds = 16;
+			Uint32 desired_frame_duration_milliseconds = 1000 / frame_rate_cap;
 
 			int delay_ticks = std::max(static_cast<int>(desired_frame_duration_milliseconds) - static_cast<int>(current_frame_duration_milliseconds), 1);
 
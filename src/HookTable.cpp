@@ -0,0 +1,94 @@
+#include "ComponentDB.h"
+#include "HookTable.h"
+
+#include <algorithm>
+
+bool HookTable::Before(const HookEntry& a, const HookEntry& b) {
+	if (a.order != b.order) {
+		return a.order < b.order;
+	}
+	return ComponentDB::KeyRank(a.keyId) < ComponentDB::KeyRank(b.keyId);
+}
+
+void HookTable::RegisterActor(Actor* actor) {
+	actor->hookOrder = (static_cast<uint64_t>(HookTable::epoch) << 32) | static_cast<uint32_t>(actor->GetID());
+	actor->registered = true;
+	for (auto& component : actor->keyedComponents) {
+		HookTable::RegisterComponent(actor, component.second);
+	}
+}
+
+void HookTable::RegisterComponent(Actor* actor, const std::shared_ptr<Component>& component) {
+	// Template actors and actors still being assembled pick their components up in RegisterActor.
+	if (!actor->registered) {
+		return;
+	}
+	// Read here rather than with the hooks, so a scene's overrides of an inherited component count.
+	component->ResolvePolicy();
+	HookTable::generation++;
+
+	for (int hook = 0; hook < HOOK_COUNT; hook++) {
+		if (component->HasHook(static_cast<HOOK_TYPE>(hook))) {
+			HookTable::pending[hook].push_back({ actor->hookOrder, component->keyId, actor, component, component->attachment });
+		}
+	}
+}
+
+void HookTable::UnregisterActor(Actor* actor) {
+	for (auto& component : actor->keyedComponents) {
+		HookTable::UnregisterComponent(component.second);
+	}
+	actor->registered = false;
+}
+
+void HookTable::UnregisterComponent(const std::shared_ptr<Component>& component) {
+	component->detached = true;
+	component->attachment++;
+	HookTable::hasTombstones = true;
+	HookTable::generation++;
+}
+
+HookRange HookTable::ActorEntries(HOOK_TYPE hook, Actor* actor) {
+	auto& vec = HookTable::entries[hook];
+	auto first = std::lower_bound(vec.begin(), vec.end(), actor->hookOrder,
+		[](const HookEntry& entry, uint64_t order) { return entry.order < order; });
+	auto last = std::upper_bound(first, vec.end(), actor->hookOrder,
+		[](uint64_t order, const HookEntry& entry) { return order < entry.order; });
+	// IDs only repeat within an epoch for save-restored actors, so the slice is almost always exact.
+	return HookRange(vec.data() + (first - vec.begin()), vec.data() + (last - vec.begin()), actor);
+}
+
+void HookTable::Flush() {
+	for (int hook = 0; hook < HOOK_COUNT; hook++) {
+		auto& added = HookTable::pending[hook];
+		if (added.empty()) {
+			continue;
+		}
+
+		// New arrivals are few next to the live set, so sort them alone and merge in linear time.
+		auto& vec = HookTable::entries[hook];
+		std::sort(added.begin(), added.end(), &HookTable::Before);
+		size_t middle = vec.size();
+		vec.insert(vec.end(), std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+		std::inplace_merge(vec.begin(), vec.begin() + middle, vec.end(), &HookTable::Before);
+		added.clear();
+		HookTable::generation++;
+	}
+}
+
+void HookTable::Compact() {
+	if (!HookTable::hasTombstones) {
+		return;
+	}
+
+	auto detached = [](const HookEntry& entry) {
+		return entry.Stale();
+	};
+	for (int hook = 0; hook < HOOK_COUNT; hook++) {
+		auto& vec = HookTable::entries[hook];
+		vec.erase(std::remove_if(vec.begin(), vec.end(), detached), vec.end());
+		auto& added = HookTable::pending[hook];
+		added.erase(std::remove_if(added.begin(), added.end(), detached), added.end());
+	}
+	HookTable::hasTombstones = false;
+}
\ No newline at end of file
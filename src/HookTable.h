@@ -0,0 +1,108 @@
+#pragma once
+#include "Actor.h"
+#include "Component.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct HookEntry {
+	uint64_t order = 0; // Owner's Actor::hookOrder
+	uint32_t keyId = 0;
+	Actor* actor = nullptr;
+	std::shared_ptr<Component> component;
+	uint32_t attachment = 0; // component->attachment when this entry was made
+
+	bool Stale() const {
+		return component->detached || attachment != component->attachment;
+	}
+};
+
+/* A slice of one hook's array. Iteration steps over tombstones and, when actor is set, other actors. */
+class HookRange {
+public:
+	class Iterator {
+	public:
+		Iterator(const HookEntry* entry, const HookEntry* last, const Actor* actor)
+			: entry(entry), last(last), actor(actor) {
+			Skip();
+		}
+		const HookEntry& operator*() const {
+			return *entry;
+		}
+		const HookEntry* operator->() const {
+			return entry;
+		}
+		Iterator& operator++() {
+			++entry;
+			Skip();
+			return *this;
+		}
+		bool operator!=(const Iterator& other) const {
+			return entry != other.entry;
+		}
+	private:
+		const HookEntry* entry;
+		const HookEntry* last;
+		const Actor* actor;
+
+		void Skip() {
+			while (entry != last && (entry->Stale() || (actor != nullptr && entry->actor != actor))) {
+				++entry;
+			}
+		}
+	};
+
+	HookRange(const HookEntry* first, const HookEntry* last, const Actor* actor = nullptr)
+		: first(first), last(last), actor(actor) {}
+	Iterator begin() const {
+		return Iterator(first, last, actor);
+	}
+	Iterator end() const {
+		return Iterator(last, last, actor);
+	}
+private:
+	const HookEntry* first;
+	const HookEntry* last;
+	const Actor* actor;
+};
+
+/* One dense array per lifecycle hook for every live actor, sorted by (scene epoch, actor ID, key).
+   New entries wait in pending until Flush and removals stay as tombstones until Compact,
+   so the arrays never move under a dispatch loop. */
+class HookTable {
+public:
+	static void NextEpoch() {
+		HookTable::epoch++;
+	}
+	static void RegisterActor(Actor* actor);
+	static void RegisterComponent(Actor* actor, const std::shared_ptr<Component>& component);
+	static void UnregisterActor(Actor* actor);
+	static void UnregisterComponent(const std::shared_ptr<Component>& component);
+
+	static HookRange Entries(HOOK_TYPE hook) {
+		auto& vec = HookTable::entries[hook];
+		return HookRange(vec.data(), vec.data() + vec.size());
+	}
+	static HookRange ActorEntries(HOOK_TYPE hook, Actor* actor);
+	static void Consume(HOOK_TYPE hook) {
+		HookTable::entries[hook].clear();
+		HookTable::generation++;
+	}
+
+	static void Flush();
+	static void Compact();
+	static uint64_t Generation() {
+		return HookTable::generation;
+	}
+private:
+	// Actors retained across a scene load keep running ahead of the new scene's actors, whose IDs restart at 0.
+	static inline uint32_t epoch = 0;
+	static inline std::vector<HookEntry> entries[HOOK_COUNT];
+	static inline std::vector<HookEntry> pending[HOOK_COUNT];
+	static inline bool hasTombstones = false;
+	static inline uint64_t generation = 0; // Bumped whenever the set of live entries may have changed
+
+	static bool Before(const HookEntry& a, const HookEntry& b);
+	HookTable() {}
+};
\ No newline at end of file
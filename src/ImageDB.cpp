@@ -1,73 +1,152 @@
 #include "ComponentDB.h"
 #include "ImageDB.h"
+#include "Profiler.h"
 #include "Renderer.h"
+#include "TextureAtlas.h"
 
 #include "Helper.h"
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <string_view>
+
 #include "Lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
 #include "SDL2_Img/SDL_image.h"
 
-void DrawUI(const std::string& image_name, float x, float y) {
+/* An image name as Lua passed it to a draw call. A string is viewed where Lua keeps it, so a draw builds no
+   std::string; anything else is converted the way a std::string argument is, so Image.Draw(3, x, y) still
+   draws resources/images/3.png. */
+struct ImageName {
+	std::string_view view;
+	std::string converted;
+	bool isString = true;
+
+	std::string_view Get() const {
+		return this->isString ? this->view : std::string_view(this->converted);
+	}
+};
+
+namespace luabridge {
+template <>
+struct Stack<ImageName> {
+	static ImageName get(lua_State* L, int index) {
+		ImageName name;
+		if (lua_type(L, index) == LUA_TSTRING) {
+			size_t length = 0;
+			const char* text = lua_tolstring(L, index, &length);
+			name.view = std::string_view(text, length);
+		}
+		else {
+			name.isString = false;
+			name.converted = Stack<std::string>::get(L, index);
+		}
+		return name;
+	}
+	static bool isInstance(lua_State* L, int index) {
+		return lua_type(L, index) == LUA_TSTRING;
+	}
+};
+}
+
+SDL_Texture* ImageDB::LoadTexture(const std::string& image_name) {
+	std::string imagePath = "resources/images/" + image_name + ".png";
+	SDL_Texture* texture = nullptr;
+	Renderer::RunOnRenderThread([&imagePath, &texture]() {
+		texture = IMG_LoadTexture(Renderer::renderer_ptr, imagePath.c_str());
+	});
+	return texture;
+}
+
+const ImageDB::ResolvedImage& ImageDB::Lookup(std::string_view image_name) {
+	auto it = ImageDB::resolved.find(image_name);
+	if (it != ImageDB::resolved.end()) {
+		return it->second;
+	}
+
+	const std::string& name = ImageDB::resolvedNames.emplace_back(image_name);
+	ResolvedImage image = { nullptr, { 0, 0, 0, 0 }, 0.0f, 0.0f };
+	if (const AtlasRegion* region = TextureAtlas::Find(name)) {
+		image.texture = region->page;
+		image.src = region->rect;
+		image.w = static_cast<float>(region->rect.w);
+		image.h = static_cast<float>(region->rect.h);
+	}
+	else {
+		auto loaded = ImageDB::imageMap.find(name);
+		if (loaded != ImageDB::imageMap.end()) {
+			image.texture = loaded->second;
+		}
+		else {
+			image.texture = ImageDB::LoadTexture(name);
+			ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(name, image.texture));
+		}
+		Helper::SDL_QueryTexture(image.texture, &image.w, &image.h);
+	}
+	return ImageDB::resolved.emplace(name, image).first->second;
+}
+
+SDL_Texture* ImageDB::Resolve(std::string_view image_name, SDL_Rect& src) {
+	const ResolvedImage& image = ImageDB::Lookup(image_name);
+	src = image.src;
+	return image.texture;
+}
+
+void ImageDB::ForgetResolved() {
+	ImageDB::resolved.clear();
+	ImageDB::resolvedNames.clear();
+}
+
+void ImageDB::AdoptSurface(const std::string& image_name, SDL_Surface* surface) {
+	if (ImageDB::imageMap.find(image_name) == ImageDB::imageMap.end()) {
+		SDL_Texture* texture = nullptr;
+		Renderer::RunOnRenderThread([surface, &texture]() {
+			texture = SDL_CreateTextureFromSurface(Renderer::renderer_ptr, surface);
+		});
+		ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(image_name, texture));
+	}
+	SDL_FreeSurface(surface);
+}
+
+// Through int, as the old int fields did: a channel past 255 wraps instead of being undefined.
+SDL_Color ToColor(float r, float g, float b, float a) {
+	return { static_cast<Uint8>(static_cast<int>(r)), static_cast<Uint8>(static_cast<int>(g)),
+		static_cast<Uint8>(static_cast<int>(b)), static_cast<Uint8>(static_cast<int>(a)) };
+}
+
+void DrawUI(ImageName image_name, float x, float y) {
 	UIStruct ui;
 	ui.x = x;
 	ui.y = y;
 
-	try {
-		ui.img = ImageDB::imageMap.at(image_name);
-	}
-	catch (const std::out_of_range&) {
-		std::string imagePath = "resources/images/" + image_name + ".png";
-		SDL_Texture* temp_ptr = IMG_LoadTexture(Renderer::renderer_ptr, imagePath.c_str());
-		ui.img = temp_ptr;
-		ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(image_name, temp_ptr));
-	}
+	ui.img = ImageDB::Resolve(image_name.Get(), ui.src);
 
 	ImageDB::UIImgQueue.push_back(ui);
 }
 
-void DrawUIEx(const std::string& image_name, float x, float y, float r, float g, float b, float a, float sorting_order) {
+void DrawUIEx(ImageName image_name, float x, float y, float r, float g, float b, float a, float sorting_order) {
 	UIStruct ui;
 	ui.x = x;
 	ui.y = y;
-	ui.r = r;
-	ui.g = g;
-	ui.b = b;
-	ui.a = a;
+	ui.color = ToColor(r, g, b, a);
 	ui.sorting_order = sorting_order;
 
-	try {
-		ui.img = ImageDB::imageMap.at(image_name);
-	}
-	catch (const std::out_of_range&) {
-		std::string imagePath = "resources/images/" + image_name + ".png";
-		SDL_Texture* temp_ptr = IMG_LoadTexture(Renderer::renderer_ptr, imagePath.c_str());
-		ui.img = temp_ptr;
-		ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(image_name, temp_ptr));
-	}
+	ui.img = ImageDB::Resolve(image_name.Get(), ui.src);
 
 	ImageDB::UIImgQueue.push_back(ui);
 }
 
-void Draw(const std::string& image_name, float x, float y) {
-	SceneImgStruct sce;
-	sce.x = x;
-	sce.y = y;
-
-	try {
-		sce.img = ImageDB::imageMap.at(image_name);
-	}
-	catch (const std::out_of_range&) {
-		std::string imagePath = "resources/images/" + image_name + ".png";
-		SDL_Texture* temp_ptr = IMG_LoadTexture(Renderer::renderer_ptr, imagePath.c_str());
-		sce.img = temp_ptr;
-		ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(image_name, temp_ptr));
-	}
+void Draw(ImageName image_name, float x, float y) {
+	ImageDB::DrawEx(image_name.Get(), x, y, 0.0f, 1.0f, 1.0f, 0.5f, 0.5f, 255.0f, 255.0f, 255.0f, 255.0f, 0.0f);
+}
 
-	ImageDB::sceneImgQueue.push_back(sce);
+void DrawEx(ImageName image_name, float x, float y, float rotation_degrees, float scale_x, float scale_y,
+	float pivot_x, float pivot_y, float r, float g, float b, float a, float sorting_order) {
+	ImageDB::DrawEx(image_name.Get(), x, y, rotation_degrees, scale_x, scale_y, pivot_x, pivot_y, r, g, b, a, sorting_order);
 }
 
-void ImageDB::DrawEx(const std::string& image_name, float x, float y, float rotation_degrees, float scale_x, float scale_y, 
+void ImageDB::DrawEx(std::string_view image_name, float x, float y, float rotation_degrees, float scale_x, float scale_y, 
 	float pivot_x, float pivot_y, float r, float g, float b, float a, float sorting_order) {
 	SceneImgStruct sce;
 	sce.x = x;
@@ -77,25 +156,62 @@ void ImageDB::DrawEx(const std::string& image_name, float x, float y, float rota
 	sce.scale_y = scale_y;
 	sce.pivot_x = pivot_x;
 	sce.pivot_y = pivot_y;
-	sce.r = r;
-	sce.g = g;
-	sce.b = b;
-	sce.a = a;
+	sce.color = ToColor(r, g, b, a);
 	sce.sorting_order = sorting_order;
 
-	try {
-		sce.img = ImageDB::imageMap.at(image_name);
-	}
-	catch (const std::out_of_range&) {
-		std::string imagePath = "resources/images/" + image_name + ".png";
-		SDL_Texture* temp_ptr = IMG_LoadTexture(Renderer::renderer_ptr, imagePath.c_str());
-		sce.img = temp_ptr;
-		ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(image_name, temp_ptr));
-	}
+	const ResolvedImage& image = ImageDB::Lookup(image_name);
+	sce.img = image.texture;
+	sce.src = image.src;
+	sce.w = image.w;
+	sce.h = image.h;
 
 	ImageDB::sceneImgQueue.push_back(sce);
 }
 
+bool ImageDB::InView(const SceneImgStruct& sce, float camera_x, float camera_y, float scale) {
+	// The same placement DrawFrame works out, in pixels before the render scale is applied.
+	float pivot_x = (sce.x - camera_x) * Renderer::UNIT_TO_PIXELS_CONVERSION + Renderer::WINDOW_CENTER.x / scale;
+	float pivot_y = (sce.y - camera_y) * Renderer::UNIT_TO_PIXELS_CONVERSION + Renderer::WINDOW_CENTER.y / scale;
+	float w = sce.w * std::abs(sce.scale_x);
+	float h = sce.h * std::abs(sce.scale_y);
+	float left = sce.pivot_x * w;
+	float top = sce.pivot_y * h;
+	float right = w - left;
+	float bottom = h - top;
+
+	// Rotation is about the pivot, so a rotated image stays inside the circle through its farthest corner.
+	if (sce.rotation_degrees % 360 != 0) {
+		float radius = std::sqrt(std::max(left * left, right * right) + std::max(top * top, bottom * bottom));
+		left = radius;
+		top = radius;
+		right = radius;
+		bottom = radius;
+	}
+
+	// One extra pixel for DrawFrame truncating the rect to whole pixels.
+	float margin = ImageDB::cullMargin / scale + 1.0f;
+	float view_w = Renderer::WINDOW_RESOLUTION.x / scale;
+	float view_h = Renderer::WINDOW_RESOLUTION.y / scale;
+	return pivot_x + right >= -margin && pivot_x - left <= view_w + margin
+		&& pivot_y + bottom >= -margin && pivot_y - top <= view_h + margin;
+}
+
+void ImageDB::EndFrame(float camera_x, float camera_y, float render_scale) {
+	size_t queued = ImageDB::sceneImgQueue.size();
+	if (ImageDB::culling) {
+		// remove_if keeps the survivors in submission order, which is what DrawSort breaks ties on.
+		ImageDB::sceneImgQueue.erase(std::remove_if(ImageDB::sceneImgQueue.begin(), ImageDB::sceneImgQueue.end(),
+			[camera_x, camera_y, render_scale](const SceneImgStruct& sce) {
+				return !ImageDB::InView(sce, camera_x, camera_y, render_scale);
+			}), ImageDB::sceneImgQueue.end());
+	}
+	ImageDB::lastDrawn = static_cast<int>(ImageDB::sceneImgQueue.size());
+	ImageDB::lastCulled = static_cast<int>(queued) - ImageDB::lastDrawn;
+	if (ImageDB::culling) {
+		Profiler::Counter("CulledDraws", static_cast<double>(ImageDB::lastCulled));
+	}
+}
+
 void DrawPixel(float x, float y, float r, float g, float b, float a) {
 	PixStruct pix;
 
@@ -115,15 +231,16 @@ void ImageDB::LuaInit() {
 		.addFunction("DrawUI", &DrawUI)
 		.addFunction("DrawUIEx", &DrawUIEx)
 		.addFunction("Draw", &Draw)
-		.addFunction("DrawEx", &ImageDB::DrawEx)
+		.addFunction("DrawEx", &DrawEx)
 		.addFunction("DrawPixel", &DrawPixel)
+		.addFunction("GetCulledCount", &ImageDB::GetCulledCount)
+		.addFunction("GetDrawnCount", &ImageDB::GetDrawnCount)
 		.endNamespace();
 }
 
-void ImageDB::LoadViewImage(SDL_Renderer* renderer, std::string& imageName, SDL_Texture*& image_ptr) {
-	if (ImageDB::imageMap.find(imageName) == ImageDB::imageMap.end()) {
-		std::string imagePath = "resources/images/" + imageName + ".png";
-		SDL_Texture* temp_ptr = IMG_LoadTexture(renderer, imagePath.c_str());
+void ImageDB::LoadViewImage(std::string& imageName, SDL_Texture*& image_ptr) {
+	if (TextureAtlas::Find(imageName) == nullptr && ImageDB::imageMap.find(imageName) == ImageDB::imageMap.end()) {
+		SDL_Texture* temp_ptr = ImageDB::LoadTexture(imageName);
 		image_ptr = temp_ptr;
 		ImageDB::imageMap.insert(std::pair<std::string, SDL_Texture*>(imageName, temp_ptr));
 	}
@@ -139,7 +256,10 @@ void ImageDB::CreateDefaultTextureWithName(const std::string& name) {
 	Uint32 white_color = SDL_MapRGBA(surf->format, 255, 255, 255, 255);
 	SDL_FillRect(surf, NULL, white_color);
 
-	SDL_Texture* text = SDL_CreateTextureFromSurface(Renderer::renderer_ptr, surf);
+	SDL_Texture* text = nullptr;
+	Renderer::RunOnRenderThread([surf, &text]() {
+		text = SDL_CreateTextureFromSurface(Renderer::renderer_ptr, surf);
+	});
 
 	SDL_FreeSurface(surf);
 	imageMap[name] = text;
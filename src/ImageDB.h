@@ -1,16 +1,17 @@
 #pragma once
+#include <deque>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "SDL2_Img/SDL_image.h"
 
+/* Draw commands are plain records, appended to vectors that keep their capacity from frame to frame. */
 struct SceneImgStruct {
 	int rotation_degrees = 0;
-	int r = 255;
-	int g = 255;
-	int b = 255;
-	int a = 255;
+	SDL_Color color = { 255, 255, 255, 255 };
 	int sorting_order = 0;
 	float x;
 	float y;
@@ -19,17 +20,18 @@ struct SceneImgStruct {
 	float pivot_x = 0.5f;
 	float pivot_y = 0.5f;
 	SDL_Texture* img;
+	SDL_Rect src = { 0, 0, 0, 0 }; // The image's region of an atlas page; empty for the whole texture
+	float w = 0.0f; // Unscaled size in pixels, for culling
+	float h = 0.0f;
 };
 
 struct UIStruct {
 	int x;
 	int y;
-	int r = 255;
-	int g = 255;
-	int b = 255;
-	int a = 255;
+	SDL_Color color = { 255, 255, 255, 255 };
 	int sorting_order = 0;
 	SDL_Texture* img;
+	SDL_Rect src = { 0, 0, 0, 0 }; // The image's region of an atlas page; empty for the whole texture
 };
 
 struct PixStruct {
@@ -43,19 +45,51 @@ struct PixStruct {
 
 class ImageDB {
 public:
-	static inline std::deque<SceneImgStruct> sceneImgQueue;
-	static inline std::deque<UIStruct> UIImgQueue;
+	static inline std::vector<SceneImgStruct> sceneImgQueue;
+	static inline std::vector<UIStruct> UIImgQueue;
 	static inline std::queue<PixStruct> pixImgQueue;
 
 	static inline std::unordered_map<std::string, SDL_Texture*> imageMap;
 
+	static inline bool culling = false; // rendering.config "frustum_culling"
+	static inline float cullMargin = 0.0f; // Screen pixels past the edge still drawn, rendering.config "cull_margin"
+
 	static void LuaInit();
 
-	static void LoadViewImage(SDL_Renderer* renderer, std::string& imageName, SDL_Texture*& image_ptr);
+	static SDL_Texture* LoadTexture(const std::string& image_name); // Always runs on the thread owning the renderer
+	static SDL_Texture* Resolve(std::string_view image_name, SDL_Rect& src); // Loads on first use unless it is atlased
+	static void ForgetResolved(); // After images move, e.g. into or out of the atlas
+	static void AdoptSurface(const std::string& image_name, SDL_Surface* surface); // Decoded elsewhere; frees it
+	static void LoadViewImage(std::string& imageName, SDL_Texture*& image_ptr);
 	static void CreateDefaultTextureWithName(const std::string& name);
-	static void DrawEx(const std::string& image_name, float x, float y, float rotation_degrees, float scale_x, float scale_y,
+	static void DrawEx(std::string_view image_name, float x, float y, float rotation_degrees, float scale_x, float scale_y,
 		float pivot_x, float pivot_y, float r, float g, float b, float a, float sorting_order);
+	// Called as the frame is captured: culls its scene draws against the camera and scale they will be
+	// drawn with, then publishes the counts.
+	static void EndFrame(float camera_x, float camera_y, float render_scale);
+	static int GetCulledCount() {
+		return ImageDB::lastCulled;
+	}
+	static int GetDrawnCount() {
+		return ImageDB::lastDrawn;
+	}
 private:
+	/* Names already resolved, so a draw is one hash of the name Lua passed in: no std::string is built
+	   and neither the atlas nor imageMap is consulted. The keys view resolvedNames. */
+	struct ResolvedImage {
+		SDL_Texture* texture;
+		SDL_Rect src;
+		float w; // Unscaled size in pixels, for culling
+		float h;
+	};
+	static inline std::deque<std::string> resolvedNames;
+	static inline std::unordered_map<std::string_view, ResolvedImage> resolved;
+
+	static inline int lastCulled = 0;
+	static inline int lastDrawn = 0;
+
+	static const ResolvedImage& Lookup(std::string_view image_name);
+	static bool InView(const SceneImgStruct& sce, float camera_x, float camera_y, float scale);
 
 	ImageDB();
 };
\ No newline at end of file
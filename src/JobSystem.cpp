@@ -0,0 +1,223 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+thread_local int workerIndex = 0; // 0 for the main thread and any non-worker caller
+
+void ShutdownAtExit() {
+	JobSystem::Shutdown();
+}
+
+void JobSystem::Init(int worker_count) {
+	if (JobSystem::running.load()) {
+		return;
+	}
+
+	if (worker_count < 0) {
+		// The main thread helps whenever it waits, so it counts as one of the hardware threads.
+		worker_count = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+	}
+
+	JobSystem::queues.clear();
+	for (int i = 0; i <= worker_count; i++) {
+		JobSystem::queues.push_back(std::make_unique<JobQueue>());
+	}
+
+	JobSystem::running.store(true);
+	for (int i = 1; i <= worker_count; i++) {
+		JobSystem::workers.emplace_back(&JobSystem::WorkerLoop, i);
+	}
+
+	static bool registered = false;
+	if (!registered) {
+		std::atexit(&ShutdownAtExit);
+		registered = true;
+	}
+}
+
+void JobSystem::Shutdown() {
+	if (!JobSystem::running.exchange(false)) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(JobSystem::sleepMutex);
+		JobSystem::sleepSignal.notify_all();
+	}
+	for (auto& worker : JobSystem::workers) {
+		worker.join();
+	}
+	JobSystem::workers.clear();
+}
+
+void JobSystem::Push(std::function<void()> job, const std::shared_ptr<JobCounter>& counter) {
+	if (!JobSystem::running.load()) {
+		// No pool (not initialized or shutting down): run inline so callers still make progress.
+		job();
+		JobSystem::Finish(counter);
+		return;
+	}
+
+	JobQueue& queue = *JobSystem::queues[workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.emplace_back(std::move(job), counter);
+	}
+	JobSystem::queuedJobs.fetch_add(1, std::memory_order_release);
+
+	std::lock_guard<std::mutex> lock(JobSystem::sleepMutex);
+	JobSystem::sleepSignal.notify_one();
+}
+
+void JobSystem::Run(std::function<void()> job, const std::shared_ptr<JobCounter>& counter) {
+	if (counter) {
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	JobSystem::Push(std::move(job), counter);
+}
+
+void JobSystem::RunAfter(const std::shared_ptr<JobCounter>& dependency, std::function<void()> job,
+	const std::shared_ptr<JobCounter>& counter) {
+	if (counter) {
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (dependency) {
+		std::lock_guard<std::mutex> lock(dependency->continuationMutex);
+		if (!dependency->Done()) {
+			dependency->continuations.emplace_back(std::move(job), counter);
+			return;
+		}
+	}
+	JobSystem::Push(std::move(job), counter);
+}
+
+void JobSystem::Finish(const std::shared_ptr<JobCounter>& counter) {
+	if (!counter) {
+		return;
+	}
+
+	std::vector<std::pair<std::function<void()>, std::shared_ptr<JobCounter>>> ready;
+	{
+		// Taking the lock around the final decrement keeps RunAfter from missing the transition.
+		std::lock_guard<std::mutex> lock(counter->continuationMutex);
+		if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			ready.swap(counter->continuations);
+		}
+	}
+	for (auto& continuation : ready) {
+		JobSystem::Push(std::move(continuation.first), continuation.second);
+	}
+}
+
+bool JobSystem::TryRunOne(int index) {
+	if (JobSystem::queuedJobs.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	std::pair<std::function<void()>, std::shared_ptr<JobCounter>> job;
+	bool found = false;
+
+	{
+		// Own queue is LIFO for cache warmth.
+		JobQueue& own = *JobSystem::queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			found = true;
+		}
+	}
+
+	for (size_t offset = 1; !found && offset < JobSystem::queues.size(); offset++) {
+		// Steal the oldest job from a victim, which tends to be the largest remaining chunk.
+		JobQueue& victim = *JobSystem::queues[(index + offset) % JobSystem::queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			found = true;
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	JobSystem::queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+	{
+		PROFILE_SCOPE("Job");
+		job.first();
+	}
+	JobSystem::Finish(job.second);
+	return true;
+}
+
+void JobSystem::WorkerLoop(int index) {
+	workerIndex = index;
+	while (JobSystem::running.load(std::memory_order_acquire)) {
+		if (!JobSystem::TryRunOne(index)) {
+			std::unique_lock<std::mutex> lock(JobSystem::sleepMutex);
+			JobSystem::sleepSignal.wait_for(lock, std::chrono::milliseconds(2), [] {
+				return !JobSystem::running.load() || JobSystem::queuedJobs.load() > 0;
+			});
+		}
+	}
+}
+
+void JobSystem::Wait(const std::shared_ptr<JobCounter>& counter) {
+	if (!counter) {
+		return;
+	}
+	while (!counter->Done()) {
+		if (!JobSystem::TryRunOne(workerIndex)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::HelpUntil(std::chrono::steady_clock::time_point deadline) {
+	while (std::chrono::steady_clock::now() < deadline) {
+		if (!JobSystem::TryRunOne(workerIndex)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	}
+}
+
+void JobSystem::ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+	if (end <= begin) {
+		return;
+	}
+	grain = std::max(grain, 1);
+	if (end - begin <= grain || JobSystem::WorkerCount() == 0) {
+		body(begin, end);
+		return;
+	}
+
+	auto counter = JobSystem::MakeCounter();
+	for (int chunk = begin + grain; chunk < end; chunk += grain) {
+		int chunk_end = std::min(chunk + grain, end);
+		JobSystem::Run([&body, chunk, chunk_end]() { body(chunk, chunk_end); }, counter);
+	}
+	body(begin, std::min(begin + grain, end));
+	JobSystem::Wait(counter);
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> job) {
+	std::lock_guard<std::mutex> lock(JobSystem::mainThreadMutex);
+	JobSystem::mainThreadJobs.push_back(std::move(job));
+}
+
+void JobSystem::DrainMainThreadQueue() {
+	std::vector<std::function<void()>> jobs;
+	{
+		std::lock_guard<std::mutex> lock(JobSystem::mainThreadMutex);
+		jobs.swap(JobSystem::mainThreadJobs);
+	}
+	for (auto& job : jobs) {
+		job();
+	}
+}
\ No newline at end of file
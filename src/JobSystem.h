@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Counts outstanding jobs. Wait on it to join; jobs queued with RunAfter start once it reaches zero. */
+class JobCounter {
+public:
+	bool Done() const {
+		return pending.load(std::memory_order_acquire) == 0;
+	}
+private:
+	std::atomic<int> pending{ 0 };
+	std::mutex continuationMutex;
+	std::vector<std::pair<std::function<void()>, std::shared_ptr<JobCounter>>> continuations;
+	friend class JobSystem;
+};
+
+struct JobQueue {
+	std::mutex mutex;
+	std::deque<std::pair<std::function<void()>, std::shared_ptr<JobCounter>>> jobs;
+};
+
+class JobSystem {
+public:
+	static void Init(int worker_count = -1);
+	static void Shutdown();
+	static int WorkerCount() {
+		return static_cast<int>(workers.size());
+	}
+
+	static std::shared_ptr<JobCounter> MakeCounter() {
+		return std::make_shared<JobCounter>();
+	}
+	static void Run(std::function<void()> job, const std::shared_ptr<JobCounter>& counter = nullptr);
+	static void RunAfter(const std::shared_ptr<JobCounter>& dependency, std::function<void()> job,
+		const std::shared_ptr<JobCounter>& counter = nullptr);
+	static void Wait(const std::shared_ptr<JobCounter>& counter);
+	static void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+	static void HelpUntil(std::chrono::steady_clock::time_point deadline);
+
+	static void RunOnMainThread(std::function<void()> job);
+	static void DrainMainThreadQueue();
+private:
+	static inline std::atomic<bool> running{ false };
+	static inline std::vector<std::thread> workers;
+	static inline std::vector<std::unique_ptr<JobQueue>> queues; // Slot 0 belongs to the main thread
+	static inline std::mutex sleepMutex;
+	static inline std::condition_variable sleepSignal;
+	static inline std::atomic<int> queuedJobs{ 0 };
+	static inline std::mutex mainThreadMutex;
+	static inline std::vector<std::function<void()>> mainThreadJobs;
+
+	static void WorkerLoop(int index);
+	static void Push(std::function<void()> job, const std::shared_ptr<JobCounter>& counter);
+	static bool TryRunOne(int index);
+	static void Finish(const std::shared_ptr<JobCounter>& counter);
+	JobSystem() {}
+};
\ No newline at end of file
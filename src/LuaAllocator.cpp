@@ -0,0 +1,214 @@
+#include "LuaAllocator.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Lua/lua.hpp"
+
+const size_t SIZE_CLASS_COUNT = LuaAllocator::MAX_SMALL_BYTES / LuaAllocator::GRANULE_BYTES;
+
+struct FreeBlock {
+	FreeBlock* next;
+};
+
+struct SizeClassPool {
+	FreeBlock* freeList = nullptr;
+	char* cursor = nullptr; // Uncarved tail of this class's newest chunk
+	char* end = nullptr;
+};
+
+struct LuaPool {
+	SizeClassPool classes[SIZE_CLASS_COUNT];
+	size_t reservedBytes = 0;
+};
+
+LuaPool& ThreadPool() {
+	// Chunks are never handed back, and the pool is never deleted, so a block freed on another
+	// thread, or after its thread has exited, still points at live memory.
+	thread_local LuaPool* pool = nullptr;
+	if (pool == nullptr) {
+		pool = new LuaPool();
+	}
+	return *pool;
+}
+
+size_t SizeClass(size_t size) {
+	return (size - 1) / LuaAllocator::GRANULE_BYTES;
+}
+
+bool IsSmall(size_t size) {
+	return size <= LuaAllocator::MAX_SMALL_BYTES;
+}
+
+void Account(LuaAllocStats* stats, bool created, size_t osize, size_t nsize) {
+	stats->liveBytes = stats->liveBytes - osize + nsize;
+	stats->peakBytes = std::max(stats->peakBytes, stats->liveBytes);
+	if (nsize == 0) {
+		stats->frees++;
+	}
+	else if (created) {
+		stats->allocations++;
+	}
+	if (nsize > osize) {
+		stats->bytesAllocated += nsize - osize;
+	}
+}
+
+int LuaPanic(lua_State* L) {
+	// Same report as luaL_newstate's handler, which lua_newstate does not install.
+	const char* message = lua_tostring(L, -1);
+	std::cout << "PANIC: unprotected error in call to Lua API ("
+		<< (message != nullptr ? message : "error object is not a string") << ")" << std::endl;
+	return 0;
+}
+
+bool LuaAllocator::ParseKind(const std::string& name) {
+	if (name == "pooled") {
+		LuaAllocator::kind = ALLOC_POOLED;
+	}
+	else if (name == "system") {
+		LuaAllocator::kind = ALLOC_SYSTEM;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+const char* LuaAllocator::KindName(LUA_ALLOCATOR allocator_kind) {
+	return allocator_kind == ALLOC_POOLED ? "pooled" : "system";
+}
+
+lua_State* LuaAllocator::NewState(LUA_ALLOCATOR allocator_kind, LuaAllocStats* state_stats) {
+	lua_Alloc alloc = allocator_kind == ALLOC_POOLED ? &LuaAllocator::Pooled : &LuaAllocator::System;
+	lua_State* L = lua_newstate(alloc, state_stats);
+	if (L != nullptr) {
+		lua_atpanic(L, &LuaPanic);
+	}
+	return L;
+}
+
+void LuaAllocator::EndFrame() {
+	LuaAllocator::lastFrame = LuaAllocator::TakeFrame(&LuaAllocator::stats);
+	Profiler::Counter("LuaAllocs", static_cast<double>(LuaAllocator::lastFrame.allocations));
+}
+
+LuaAllocStats LuaAllocator::TakeFrame(LuaAllocStats* state_stats) {
+	LuaAllocStats frame = *state_stats;
+	state_stats->allocations = 0;
+	state_stats->frees = 0;
+	state_stats->bytesAllocated = 0;
+	state_stats->peakBytes = state_stats->liveBytes;
+	return frame;
+}
+
+size_t LuaAllocator::PooledBytes() {
+	return ThreadPool().reservedBytes;
+}
+
+void* LuaAllocator::Acquire(size_t size) {
+	if (!IsSmall(size)) {
+		return std::malloc(size);
+	}
+
+	LuaPool& pool = ThreadPool();
+	size_t size_class = SizeClass(size);
+	SizeClassPool& sizes = pool.classes[size_class];
+	if (sizes.freeList != nullptr) {
+		FreeBlock* block = sizes.freeList;
+		sizes.freeList = block->next;
+		return block;
+	}
+
+	// Carve blocks off the chunk as they are needed, so a class that is barely used costs one chunk at most.
+	size_t block_bytes = (size_class + 1) * LuaAllocator::GRANULE_BYTES;
+	if (sizes.cursor == nullptr || static_cast<size_t>(sizes.end - sizes.cursor) < block_bytes) {
+		char* chunk = static_cast<char*>(std::malloc(LuaAllocator::CHUNK_BYTES));
+		if (chunk == nullptr) {
+			return nullptr;
+		}
+		pool.reservedBytes += LuaAllocator::CHUNK_BYTES;
+		sizes.cursor = chunk;
+		sizes.end = chunk + LuaAllocator::CHUNK_BYTES;
+	}
+	void* block = sizes.cursor;
+	sizes.cursor += block_bytes;
+	return block;
+}
+
+void LuaAllocator::Release(void* block, size_t size) {
+	if (!IsSmall(size)) {
+		std::free(block);
+		return;
+	}
+
+	SizeClassPool& sizes = ThreadPool().classes[SizeClass(size)];
+	FreeBlock* freed = static_cast<FreeBlock*>(block);
+	freed->next = sizes.freeList;
+	sizes.freeList = freed;
+}
+
+void* LuaAllocator::Pooled(void* ud, void* ptr, size_t osize, size_t nsize) {
+	LuaAllocStats* state_stats = static_cast<LuaAllocStats*>(ud);
+	if (ptr == nullptr) {
+		osize = 0; // For a new object Lua passes its type tag here, not a size
+	}
+
+	void* result = nullptr;
+	if (nsize == 0) {
+		if (ptr == nullptr) {
+			return nullptr;
+		}
+		LuaAllocator::Release(ptr, osize);
+	}
+	else if (ptr != nullptr && IsSmall(osize) && IsSmall(nsize) && SizeClass(osize) == SizeClass(nsize)) {
+		result = ptr;
+	}
+	else if (ptr != nullptr && !IsSmall(osize) && !IsSmall(nsize)) {
+		result = std::realloc(ptr, nsize);
+		if (result == nullptr) {
+			return nullptr; // Lua keeps the old block on failure
+		}
+	}
+	else {
+		result = LuaAllocator::Acquire(nsize);
+		if (result == nullptr) {
+			return nullptr;
+		}
+		if (ptr != nullptr) {
+			std::memcpy(result, ptr, std::min(osize, nsize));
+			LuaAllocator::Release(ptr, osize);
+		}
+	}
+
+	Account(state_stats, ptr == nullptr, osize, nsize);
+	return result;
+}
+
+void* LuaAllocator::System(void* ud, void* ptr, size_t osize, size_t nsize) {
+	LuaAllocStats* state_stats = static_cast<LuaAllocStats*>(ud);
+	if (ptr == nullptr) {
+		osize = 0;
+	}
+
+	void* result = nullptr;
+	if (nsize == 0) {
+		if (ptr == nullptr) {
+			return nullptr;
+		}
+		std::free(ptr);
+	}
+	else {
+		result = std::realloc(ptr, nsize);
+		if (result == nullptr) {
+			return nullptr;
+		}
+	}
+
+	Account(state_stats, ptr == nullptr, osize, nsize);
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Lua/lua.hpp"
+
+enum LUA_ALLOCATOR { ALLOC_SYSTEM, ALLOC_POOLED };
+
+/* Per-state accounting, passed to Lua as the allocator's ud. A state is only ever used from
+   one thread at a time, so the counters need no synchronization. */
+struct LuaAllocStats {
+	size_t liveBytes = 0;
+	size_t peakBytes = 0; // The rest cover the span since the last TakeFrame
+	uint64_t allocations = 0; // Blocks created; resizes are not counted
+	uint64_t frees = 0;
+	uint64_t bytesAllocated = 0;
+};
+
+/* Small blocks come from thread-local size-class pools; anything past MAX_SMALL_BYTES goes to the
+   system allocator. Lua tells us the old size on every free and resize, so blocks carry no header. */
+class LuaAllocator {
+public:
+	static const size_t GRANULE_BYTES = 16; // Size-class step, and the alignment every block keeps
+	static const size_t MAX_SMALL_BYTES = 256;
+	static const size_t CHUNK_BYTES = 32 * 1024;
+
+	static inline LUA_ALLOCATOR kind = ALLOC_POOLED;
+	static inline LuaAllocStats stats; // The engine's main state
+	static inline LuaAllocStats lastFrame; // Snapshot taken by EndFrame
+
+	static bool ParseKind(const std::string& name);
+	static const char* KindName(LUA_ALLOCATOR allocator_kind);
+	static lua_State* NewState(LUA_ALLOCATOR allocator_kind, LuaAllocStats* state_stats);
+	static void EndFrame();
+	static LuaAllocStats TakeFrame(LuaAllocStats* state_stats);
+	static size_t PooledBytes(); // Chunk memory reserved by the calling thread's pools
+
+	static void* Pooled(void* ud, void* ptr, size_t osize, size_t nsize);
+	static void* System(void* ud, void* ptr, size_t osize, size_t nsize);
+private:
+	static void* Acquire(size_t size);
+	static void Release(void* block, size_t size);
+	LuaAllocator() {}
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "LuaHeap.h"
+#include "Profiler.h"
+
+#include <string>
+
+#include "Lua/lua.hpp"
+
+// Same pacing Lua uses on its own: a new incremental cycle once the heap has doubled since the
+// last one finished, a young collection once it has grown by a fifth.
+const int INCREMENTAL_PAUSE_PERCENT = 200;
+const int GENERATIONAL_MINOR_PERCENT = 20;
+const int OVERDUE_PERCENT = 400; // Past this the budget is not keeping up, so the cycle is finished regardless
+
+bool LuaHeap::ParseMode(const std::string& name) {
+	if (name == "auto") {
+		LuaHeap::mode = GC_AUTO;
+	}
+	else if (name == "incremental") {
+		LuaHeap::mode = GC_INCREMENTAL;
+	}
+	else if (name == "generational") {
+		LuaHeap::mode = GC_GENERATIONAL;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+void LuaHeap::Configure(lua_State* L) {
+	if (LuaHeap::mode == GC_GENERATIONAL) {
+		lua_gc(L, LUA_GCGEN, 0, 0);
+	}
+	else {
+		lua_gc(L, LUA_GCINC, 0, 0, 0);
+	}
+
+	if (LuaHeap::mode != GC_AUTO) {
+		lua_gc(L, LUA_GCSTOP);
+	}
+	LuaHeap::baselineKB = LuaHeap::HeapKB(L);
+	LuaHeap::cycleFinished = false;
+}
+
+void LuaHeap::Finish(lua_State* L) {
+	LuaHeap::baselineKB = LuaHeap::HeapKB(L);
+	LuaHeap::cycleFinished = true;
+}
+
+void LuaHeap::Step(lua_State* L) {
+	if (LuaHeap::mode == GC_AUTO) {
+		LuaHeap::lastStepMs = 0.0;
+		LuaHeap::lastHeapKB = LuaHeap::HeapKB(L);
+		return;
+	}
+
+	PROFILE_SCOPE("LuaGC");
+	uint64_t start = Profiler::Now();
+	uint64_t deadline = start + static_cast<uint64_t>(LuaHeap::stepBudgetMs * 1.0e6);
+	int heap = LuaHeap::HeapKB(L);
+
+	if (LuaHeap::mode == GC_GENERATIONAL) {
+		// Each step is a whole young collection, so one per frame at most.
+		if (heap * 100 >= LuaHeap::baselineKB * (100 + GENERATIONAL_MINOR_PERCENT)) {
+			lua_gc(L, LUA_GCSTEP, 0);
+			LuaHeap::Finish(L);
+		}
+	}
+	else if (!LuaHeap::cycleFinished || heap * 100 >= LuaHeap::baselineKB * INCREMENTAL_PAUSE_PERCENT) {
+		LuaHeap::cycleFinished = false;
+		bool overdue = heap * 100 >= LuaHeap::baselineKB * OVERDUE_PERCENT;
+		do {
+			if (lua_gc(L, LUA_GCSTEP, 0)) {
+				LuaHeap::Finish(L);
+				break;
+			}
+		} while (overdue || Profiler::Now() < deadline);
+	}
+
+	LuaHeap::lastStepMs = (Profiler::Now() - start) / 1.0e6;
+	LuaHeap::lastHeapKB = LuaHeap::HeapKB(L);
+	Profiler::Counter("LuaHeapKB", LuaHeap::lastHeapKB);
+	Profiler::Counter("LuaGCStepMs", LuaHeap::lastStepMs);
+}
+
+void LuaHeap::FullCollect(lua_State* L) {
+	PROFILE_SCOPE("LuaFullGC");
+	lua_gc(L, LUA_GCCOLLECT);
+	if (LuaHeap::mode != GC_AUTO) {
+		LuaHeap::Finish(L);
+	}
+}
\ No newline at end of file
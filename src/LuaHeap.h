@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Lua/lua.hpp"
+
+enum LUA_GC_MODE { GC_AUTO, GC_INCREMENTAL, GC_GENERATIONAL };
+
+/* Owns the Lua collector. Outside GC_AUTO the allocation-triggered collector is stopped, and the
+   engine steps it in the idle slot after each frame is handed to the renderer, within a time budget. */
+class LuaHeap {
+public:
+	static inline LUA_GC_MODE mode = GC_INCREMENTAL;
+	static inline double stepBudgetMs = 1.0;
+	static inline double lastStepMs = 0.0; // Reported per frame by the profiler and the headless benchmark
+	static inline int lastHeapKB = 0;
+
+	static bool ParseMode(const std::string& name);
+	static void Configure(lua_State* L);
+	static void Step(lua_State* L);
+	static void FullCollect(lua_State* L);
+	static int HeapKB(lua_State* L) {
+		return lua_gc(L, LUA_GCCOUNT);
+	}
+private:
+	static inline int baselineKB = 0; // Heap size right after the last finished cycle
+	static inline bool cycleFinished = false;
+
+	static void Finish(lua_State* L);
+	LuaHeap() {}
+};
\ No newline at end of file
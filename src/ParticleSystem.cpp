@@ -1,7 +1,7 @@
+#include "ActorStore.h"
 #include "ComponentDB.h"
 #include "ImageDB.h"
 #include "ParticleSystem.h"
-#include "Renderer.h"
 
 #include <iostream>
 #include <limits>
@@ -11,6 +11,10 @@
 #include "Lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
 
+luabridge::LuaRef ParticleSystemActor(const ParticleSystem* particle_system) {
+	return ActorStore::ToLua(particle_system->actor);
+}
+
 std::string ReturnParticleSystemType() {
 	return "ParticleSystem";
 }
@@ -51,7 +55,7 @@ void ParticleSystem::LuaInit() {
 		.addProperty("rotation_speed_max", &ParticleSystem::rotation_speed_max)
 		.addProperty("drag_factor", &ParticleSystem::drag_factor)
 		.addProperty("angular_drag_factor", &ParticleSystem::angular_drag_factor)
-		.addProperty("actor", &ParticleSystem::actor)
+		.addProperty("actor", &ParticleSystemActor)
 		.addProperty("image", &ParticleSystem::image)
 		.addProperty("key", &ParticleSystem::key)
 		.addProperty("type", &ParticleSystem::type)
@@ -71,7 +75,7 @@ void ParticleSystem::OnStart() {
 	}
 	else {
 		SDL_Texture* _;
-		ImageDB::LoadViewImage(Renderer::renderer_ptr, this->image, _);
+		ImageDB::LoadViewImage(this->image, _);
 	}
 
 	this->emit_angle_distribution = RandomEngine(this->emit_angle_min, this->emit_angle_max, 298);
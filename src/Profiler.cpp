@@ -0,0 +1,210 @@
+#include "ComponentDB.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+void DumpAtExit() {
+	if (Profiler::enabled) {
+		Profiler::DumpTrace(Profiler::tracePath);
+	}
+}
+
+void StartProfiler() {
+	Profiler::enabled = true;
+}
+
+void StopProfiler() {
+	Profiler::enabled = false;
+}
+
+bool DumpProfile(const std::string& path) {
+	return Profiler::DumpTrace(path);
+}
+
+void Profiler::Init() {
+#ifdef _WIN32
+	char* val = nullptr;
+	size_t length = 0;
+	_dupenv_s(&val, &length, "PROFILER");
+	if (val) {
+		Profiler::enabled = true;
+		free(val);
+	}
+#else
+	if (std::getenv("PROFILER")) {
+		Profiler::enabled = true;
+	}
+#endif
+
+	std::atexit(&DumpAtExit);
+}
+
+ProfileRing* Profiler::ThreadRing() {
+	thread_local ProfileRing* ring = nullptr;
+	if (ring == nullptr) {
+		ring = new ProfileRing();
+		std::lock_guard<std::mutex> lock(Profiler::ringsMutex);
+		ring->thread_index = static_cast<uint32_t>(Profiler::rings.size());
+		Profiler::rings.push_back(ring);
+	}
+	return ring;
+}
+
+void Profiler::Record(const char* name, uint64_t start_ns, uint64_t end_ns, const char* detail) {
+	ProfileRing* ring = Profiler::ThreadRing();
+	uint64_t index = ring->head.load(std::memory_order_relaxed);
+	ProfileEvent& event = ring->events[index % ProfileRing::CAPACITY];
+
+	event.name = name;
+	event.start_ns = start_ns;
+	event.duration_ns = end_ns - start_ns;
+	std::strncpy(event.detail, detail, sizeof(event.detail) - 1);
+	event.detail[sizeof(event.detail) - 1] = '\0';
+	event.counter = false;
+
+	ring->head.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::Counter(const char* name, double value) {
+	if (!Profiler::enabled) {
+		return;
+	}
+	ProfileRing* ring = Profiler::ThreadRing();
+	uint64_t index = ring->head.load(std::memory_order_relaxed);
+	ProfileEvent& event = ring->events[index % ProfileRing::CAPACITY];
+
+	event.name = name;
+	event.start_ns = Profiler::Now();
+	event.duration_ns = 0;
+	event.detail[0] = '\0';
+	event.counter = true;
+	event.value = value;
+
+	ring->head.store(index + 1, std::memory_order_release);
+}
+
+std::unordered_map<const char*, uint64_t>& Profiler::ThreadTotals() {
+	thread_local std::unordered_map<const char*, uint64_t> totals;
+	return totals;
+}
+
+void Profiler::Accumulate(const char* name, uint64_t duration_ns) {
+	Profiler::ThreadTotals()[name] += duration_ns;
+}
+
+std::unordered_map<std::string, uint64_t> Profiler::TakeThreadTotals() {
+	// Keyed by pointer while recording; the same literal may live at different addresses per TU.
+	std::unordered_map<std::string, uint64_t> merged;
+	for (auto& total : Profiler::ThreadTotals()) {
+		merged[total.first] += total.second;
+	}
+	Profiler::ThreadTotals().clear();
+	return merged;
+}
+
+bool Profiler::DumpTrace(const std::string& path) {
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+	writer.StartObject();
+	writer.Key("displayTimeUnit");
+	writer.String("ms");
+	writer.Key("traceEvents");
+	writer.StartArray();
+	{
+		std::lock_guard<std::mutex> lock(Profiler::ringsMutex);
+		std::vector<ProfileEvent> events;
+		for (auto ring : Profiler::rings) {
+			// Owning threads keep writing while we read. Copy up to the published head, then drop whatever
+			// the writer may have lapped meanwhile: its next slot overwrites event head_after - CAPACITY.
+			uint64_t head = ring->head.load(std::memory_order_acquire);
+			uint64_t begin = head > ProfileRing::CAPACITY ? head - ProfileRing::CAPACITY : 0;
+			events.clear();
+			for (uint64_t i = begin; i < head; i++) {
+				events.push_back(ring->events[i % ProfileRing::CAPACITY]);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			uint64_t head_after = ring->head.load(std::memory_order_relaxed);
+			uint64_t first_intact = head_after >= ProfileRing::CAPACITY ? head_after - ProfileRing::CAPACITY + 1 : 0;
+			size_t skip = first_intact > begin ? static_cast<size_t>(std::min(first_intact - begin, head - begin)) : 0;
+
+			for (size_t e = skip; e < events.size(); e++) {
+				const ProfileEvent& event = events[e];
+				if (event.counter) {
+					writer.StartObject();
+					writer.Key("name");
+					writer.String(event.name);
+					writer.Key("ph");
+					writer.String("C");
+					writer.Key("ts");
+					writer.Double(event.start_ns / 1000.0);
+					writer.Key("pid");
+					writer.Int(1);
+					writer.Key("args");
+					writer.StartObject();
+					writer.Key("value");
+					writer.Double(event.value);
+					writer.EndObject();
+					writer.EndObject();
+					continue;
+				}
+
+				writer.StartObject();
+				writer.Key("name");
+				writer.String(event.name);
+				writer.Key("cat");
+				writer.String("engine");
+				writer.Key("ph");
+				writer.String("X");
+				writer.Key("ts");
+				writer.Double(event.start_ns / 1000.0);
+				writer.Key("dur");
+				writer.Double(event.duration_ns / 1000.0);
+				writer.Key("pid");
+				writer.Int(1);
+				writer.Key("tid");
+				writer.Uint(ring->thread_index);
+				if (event.detail[0] != '\0') {
+					writer.Key("args");
+					writer.StartObject();
+					writer.Key("detail");
+					writer.String(event.detail);
+					writer.EndObject();
+				}
+				writer.EndObject();
+			}
+		}
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	std::ofstream out(path);
+	if (!out.is_open()) {
+		std::cout << "error: failed to write profile trace to " << path << std::endl;
+		return false;
+	}
+	out << buffer.GetString();
+	out.close();
+	return true;
+}
+
+void Profiler::LuaInit() {
+	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
+		.beginNamespace("Profiler")
+		.addFunction("Start", &StartProfiler)
+		.addFunction("Stop", &StopProfiler)
+		.addFunction("Dump", &DumpProfile)
+		.endNamespace();
+}
\ No newline at end of file
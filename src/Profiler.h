@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ProfileEvent {
+	const char* name = nullptr; // Always a string literal, so only the pointer is stored
+	uint64_t start_ns = 0;
+	uint64_t duration_ns = 0;
+	char detail[56] = {}; // Actor name / component type, truncated to fit
+	bool counter = false; // Counter sample: value at start_ns instead of a duration
+	double value = 0.0;
+};
+
+/* Single-producer ring owned by one thread. Writers never lock; the oldest events are overwritten. */
+struct ProfileRing {
+	static const uint32_t CAPACITY = 1 << 16;
+	uint32_t thread_index = 0;
+	std::atomic<uint64_t> head{ 0 };
+	std::vector<ProfileEvent> events = std::vector<ProfileEvent>(CAPACITY);
+};
+
+class Profiler {
+public:
+	static inline std::atomic<bool> enabled{ false }; // Read by job and render threads, flipped from Lua on the main thread
+	static inline bool collectStats = false; // Per-thread scope totals, used by the headless benchmark
+	static inline std::string tracePath = "profile_trace.json";
+
+	static void Init();
+	static void Record(const char* name, uint64_t start_ns, uint64_t end_ns, const char* detail);
+	static void Accumulate(const char* name, uint64_t duration_ns);
+	static void Counter(const char* name, double value);
+	static std::unordered_map<std::string, uint64_t> TakeThreadTotals();
+	static uint64_t Now() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - epoch).count());
+	}
+	static bool DumpTrace(const std::string& path);
+	static void LuaInit();
+private:
+	static inline std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	static inline std::mutex ringsMutex; // Guards ring registration only, never the record path
+	static inline std::vector<ProfileRing*> rings;
+
+	static ProfileRing* ThreadRing();
+	static std::unordered_map<const char*, uint64_t>& ThreadTotals();
+	Profiler() {}
+};
+
+/* Times the enclosing scope. Costs a branch when neither tracing nor stats are on. */
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* scope_name) : name(scope_name) {
+		if (Profiler::enabled || Profiler::collectStats) {
+			start = Profiler::Now();
+		}
+	}
+	~ProfileScope() {
+		if (start == 0) {
+			return;
+		}
+		uint64_t end = Profiler::Now();
+		if (Profiler::enabled) {
+			Profiler::Record(name, start, end, detail.c_str());
+		}
+		if (Profiler::collectStats) {
+			Profiler::Accumulate(name, end - start);
+		}
+	}
+	void Tag(const std::string& actor_name, const std::string& component_type) {
+		detail = actor_name + ":" + component_type;
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+	const char* name;
+	uint64_t start = 0;
+	std::string detail;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
\ No newline at end of file
@@ -1,11 +1,16 @@
 #include "ComponentDB.h"
+#include "DrawSort.h"
 #include "ImageDB.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "SceneDB.h"
+#include "SpriteBatch.h"
+#include "TextCache.h"
 #include "TextDB.h"
 
 #include "Helper.h"
 
+#include <cstdlib>
 #include <string>
 
 #include "glm/glm.hpp"
@@ -20,6 +25,20 @@ float Renderer::RENDER_SCALE = 1.0f;
 SDL_Renderer* Renderer::renderer_ptr = nullptr;
 glm::ivec2 Renderer::WINDOW_CENTER = glm::ivec2(320, 180);
 glm::ivec2 Renderer::WINDOW_RESOLUTION = glm::ivec2(640, 360);
+bool Renderer::threaded = false;
+bool Renderer::batched = false;
+SpriteBatch Renderer::spriteBatch;
+DrawSort Renderer::drawSort;
+RenderFrame Renderer::pendingFrame;
+int Renderer::submittedFrames = 0;
+std::thread Renderer::renderThread;
+std::thread::id Renderer::renderThreadId;
+std::mutex Renderer::renderMutex;
+std::condition_variable Renderer::workSignal;
+std::condition_variable Renderer::idleSignal;
+std::deque<RenderTask*> Renderer::renderTasks;
+bool Renderer::frameReady = false;
+bool Renderer::renderThreadRunning = false;
 
 void SetPosition(float x, float y) {
 	Renderer::cameraPos.x = x;
@@ -63,30 +82,158 @@ void Renderer::SetCameraHeight(int y_resolution) {
 	Renderer::WINDOW_CENTER.y = y_resolution / 2;
 }
 
-bool compareUIRequests(const UIStruct& a, const UIStruct& b) {
-	return a.sorting_order < b.sorting_order;
+void StopRenderThreadAtExit() {
+	Renderer::StopRenderThread();
 }
 
-bool compareSceneRequests(const SceneImgStruct& a, const SceneImgStruct& b) {
-	return a.sorting_order < b.sorting_order;
+void Renderer::RenderRenderer() {
+	if (!Renderer::threaded) {
+		Renderer::CaptureFrame(Renderer::pendingFrame);
+		Renderer::submittedFrames++;
+		Renderer::DrawFrame(Renderer::pendingFrame);
+		return;
+	}
+
+	// Only one frame is ever in flight: wait for frame N-1 to finish before handing over frame N.
+	std::unique_lock<std::mutex> lock(Renderer::renderMutex);
+	{
+		PROFILE_SCOPE("RenderWait");
+		Renderer::idleSignal.wait(lock, [] { return !Renderer::frameReady; });
+	}
+	Renderer::CaptureFrame(Renderer::pendingFrame);
+	Renderer::submittedFrames++;
+	Renderer::frameReady = true;
+	lock.unlock();
+	Renderer::workSignal.notify_one();
 }
 
-void Renderer::RenderRenderer() {
-	SDL_SetRenderDrawColor(Renderer::renderer_ptr, Renderer::CLEAR_COLOR.r,
-		Renderer::CLEAR_COLOR.g, Renderer::CLEAR_COLOR.b, SDL_ALPHA_TRANSPARENT);
-	SDL_RenderClear(Renderer::renderer_ptr);
+void Renderer::CaptureFrame(RenderFrame& frame) {
+	// The frame's queues were drained by the last DrawFrame, so the swap hands empty
+	// (but already allocated) queues back to the scripts for the next frame.
+	ImageDB::EndFrame(Renderer::cameraPos.x, Renderer::cameraPos.y, Renderer::RENDER_SCALE);
+	std::swap(frame.sceneImgQueue, ImageDB::sceneImgQueue);
+	std::swap(frame.UIImgQueue, ImageDB::UIImgQueue);
+	std::swap(frame.textDrawQueue, TextDB::textDrawQueue);
+	std::swap(frame.pixImgQueue, ImageDB::pixImgQueue);
+	frame.cameraPos = Renderer::cameraPos;
+	frame.renderScale = Renderer::RENDER_SCALE;
+	frame.clearColor = Renderer::CLEAR_COLOR;
+}
+
+void Renderer::StartRenderThread() {
+	if (!Renderer::threaded || Renderer::renderThreadRunning) {
+		return;
+	}
+
+	Renderer::renderThreadRunning = true;
+	Renderer::renderThread = std::thread(&Renderer::RenderThreadLoop);
+	Renderer::renderThreadId = Renderer::renderThread.get_id();
+
+	static bool registered = false;
+	if (!registered) {
+		std::atexit(&StopRenderThreadAtExit);
+		registered = true;
+	}
+}
+
+void Renderer::StopRenderThread() {
+	{
+		std::unique_lock<std::mutex> lock(Renderer::renderMutex);
+		if (!Renderer::renderThreadRunning) {
+			return;
+		}
+		Renderer::idleSignal.wait(lock, [] { return !Renderer::frameReady; });
+		Renderer::renderThreadRunning = false;
+	}
+	Renderer::workSignal.notify_one();
+	Renderer::renderThread.join();
+}
 
-	std::stable_sort(ImageDB::sceneImgQueue.begin(), ImageDB::sceneImgQueue.end(), compareSceneRequests);
+void Renderer::RunOnRenderThread(const std::function<void()>& task) {
+	if (!Renderer::threaded || !Renderer::renderThreadRunning
+		|| std::this_thread::get_id() == Renderer::renderThreadId) {
+		task();
+		return;
+	}
+
+	// SDL renderers are not thread-safe, so texture and font work is marshalled over and waited on.
+	RenderTask pending;
+	pending.work = &task;
+	std::unique_lock<std::mutex> lock(Renderer::renderMutex);
+	Renderer::renderTasks.push_back(&pending);
+	Renderer::workSignal.notify_one();
+	Renderer::idleSignal.wait(lock, [&pending] { return pending.done; });
+}
+
+void Renderer::WaitForFrame() {
+	std::unique_lock<std::mutex> lock(Renderer::renderMutex);
+	if (Renderer::renderThreadRunning) {
+		Renderer::idleSignal.wait(lock, [] { return !Renderer::frameReady; });
+	}
+}
+
+void Renderer::RenderThreadLoop() {
+	while (true) {
+		RenderTask* task = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(Renderer::renderMutex);
+			Renderer::workSignal.wait(lock, [] {
+				return !Renderer::renderTasks.empty() || Renderer::frameReady || !Renderer::renderThreadRunning;
+			});
+
+			if (!Renderer::renderTasks.empty()) {
+				task = Renderer::renderTasks.front();
+				Renderer::renderTasks.pop_front();
+			}
+			else if (!Renderer::frameReady) {
+				return;
+			}
+		}
+
+		if (task != nullptr) {
+			(*task->work)();
+			{
+				std::lock_guard<std::mutex> lock(Renderer::renderMutex);
+				task->done = true;
+			}
+			Renderer::idleSignal.notify_all();
+			continue;
+		}
+
+		{
+			PROFILE_SCOPE("RenderThreadFrame");
+			Renderer::DrawFrame(Renderer::pendingFrame);
+		}
+		{
+			std::lock_guard<std::mutex> lock(Renderer::renderMutex);
+			Renderer::frameReady = false;
+		}
+		Renderer::idleSignal.notify_all();
+	}
+}
+
+void Renderer::DrawFrame(RenderFrame& frame) {
+	SDL_SetRenderDrawColor(Renderer::renderer_ptr, frame.clearColor.r,
+		frame.clearColor.g, frame.clearColor.b, SDL_ALPHA_TRANSPARENT);
+	SDL_RenderClear(Renderer::renderer_ptr);
 
-	SDL_RenderSetScale(Renderer::renderer_ptr, Renderer::RENDER_SCALE, Renderer::RENDER_SCALE);
-	while (!ImageDB::sceneImgQueue.empty()) {
-		auto& img = ImageDB::sceneImgQueue.front();
+	SDL_RenderSetScale(Renderer::renderer_ptr, frame.renderScale, frame.renderScale);
+	for (uint32_t index : Renderer::drawSort.Order(frame.sceneImgQueue)) {
+		auto& img = frame.sceneImgQueue[index];
 
-		float rel_unit_x_pos = img.x - Renderer::cameraPos.x;
-		float rel_unit_y_pos = img.y - Renderer::cameraPos.y;
+		float rel_unit_x_pos = img.x - frame.cameraPos.x;
+		float rel_unit_y_pos = img.y - frame.cameraPos.y;
 
 		SDL_FRect img_rect = SDL_FRect();
-		Helper::SDL_QueryTexture(img.img, &img_rect.w, &img_rect.h);
+		SDL_FRect src_rect = { static_cast<float>(img.src.x), static_cast<float>(img.src.y), static_cast<float>(img.src.w), static_cast<float>(img.src.h) };
+		const SDL_FRect* src = img.src.w > 0 ? &src_rect : NULL;
+		if (src != NULL) {
+			img_rect.w = src_rect.w;
+			img_rect.h = src_rect.h;
+		}
+		else {
+			Helper::SDL_QueryTexture(img.img, &img_rect.w, &img_rect.h);
+		}
 
 
 		SDL_RendererFlip flag = SDL_FLIP_NONE;
@@ -98,60 +245,89 @@ void Renderer::RenderRenderer() {
 
 		SDL_FPoint img_piv = { (img.pivot_x * img_rect.w), (img.pivot_y * img_rect.h) };
 
-		img_rect.x = (rel_unit_x_pos * UNIT_TO_PIXELS_CONVERSION + Renderer::WINDOW_CENTER.x / Renderer::RENDER_SCALE - img_piv.x);
-		img_rect.y = (rel_unit_y_pos * UNIT_TO_PIXELS_CONVERSION + Renderer::WINDOW_CENTER.y / Renderer::RENDER_SCALE - img_piv.y);
+		img_rect.x = (rel_unit_x_pos * UNIT_TO_PIXELS_CONVERSION + Renderer::WINDOW_CENTER.x / frame.renderScale - img_piv.x);
+		img_rect.y = (rel_unit_y_pos * UNIT_TO_PIXELS_CONVERSION + Renderer::WINDOW_CENTER.y / frame.renderScale - img_piv.y);
+
+		if (Renderer::batched) {
+			Renderer::spriteBatch.Add(Renderer::renderer_ptr, img.img, src != NULL ? &img.src : NULL, img_rect, img.rotation_degrees, &img_piv, flag, img.color);
+			continue;
+		}
 
-		SDL_SetTextureColorMod(img.img, img.r, img.g, img.b);
-		SDL_SetTextureAlphaMod(img.img, img.a);
-		Helper::SDL_RenderCopyEx(0, "", Renderer::renderer_ptr, img.img, NULL, &img_rect, img.rotation_degrees, &img_piv, flag);
-		SDL_RenderSetScale(Renderer::renderer_ptr, Renderer::RENDER_SCALE, Renderer::RENDER_SCALE);
+		SDL_SetTextureColorMod(img.img, img.color.r, img.color.g, img.color.b);
+		SDL_SetTextureAlphaMod(img.img, img.color.a);
+		Helper::SDL_RenderCopyEx(0, "", Renderer::renderer_ptr, img.img, src, &img_rect, img.rotation_degrees, &img_piv, flag);
+		SDL_RenderSetScale(Renderer::renderer_ptr, frame.renderScale, frame.renderScale);
 		SDL_SetTextureAlphaMod(img.img, 255);
 		SDL_SetTextureColorMod(img.img, 255, 255, 255);
-
-		ImageDB::sceneImgQueue.pop_front();
 	}
+	frame.sceneImgQueue.clear();
+	// Scene and UI images are drawn at different scales, so they never share a batch.
+	Renderer::spriteBatch.Flush(Renderer::renderer_ptr);
 
 	SDL_RenderSetScale(Renderer::renderer_ptr, 1, 1);
 
-	std::stable_sort(ImageDB::UIImgQueue.begin(), ImageDB::UIImgQueue.end(), compareUIRequests);
-	while (!ImageDB::UIImgQueue.empty()) {
-		auto& img = ImageDB::UIImgQueue.front();
+	for (uint32_t index : Renderer::drawSort.Order(frame.UIImgQueue)) {
+		auto& img = frame.UIImgQueue[index];
 		SDL_FRect rect;
 		rect.x = img.x;
 		rect.y = img.y;
 		
-		Helper::SDL_QueryTexture(img.img, &rect.w, &rect.h);
-		SDL_SetTextureColorMod(img.img, img.r, img.g, img.b);
-		SDL_SetTextureAlphaMod(img.img, img.a);
-		Helper::SDL_RenderCopyEx(0, "", Renderer::renderer_ptr, img.img, NULL, &rect, 0.0f, NULL, SDL_FLIP_NONE);
+		SDL_FRect src_rect = { static_cast<float>(img.src.x), static_cast<float>(img.src.y), static_cast<float>(img.src.w), static_cast<float>(img.src.h) };
+		const SDL_FRect* src = img.src.w > 0 ? &src_rect : NULL;
+		if (src != NULL) {
+			rect.w = src_rect.w;
+			rect.h = src_rect.h;
+		}
+		else {
+			Helper::SDL_QueryTexture(img.img, &rect.w, &rect.h);
+		}
+		if (Renderer::batched) {
+			Renderer::spriteBatch.Add(Renderer::renderer_ptr, img.img, src != NULL ? &img.src : NULL, rect, 0.0f, NULL, SDL_FLIP_NONE, img.color);
+			continue;
+		}
+
+		SDL_SetTextureColorMod(img.img, img.color.r, img.color.g, img.color.b);
+		SDL_SetTextureAlphaMod(img.img, img.color.a);
+		Helper::SDL_RenderCopyEx(0, "", Renderer::renderer_ptr, img.img, src, &rect, 0.0f, NULL, SDL_FLIP_NONE);
 		SDL_SetTextureAlphaMod(img.img, 255);
 		SDL_SetTextureColorMod(img.img, 255, 255, 255);
-
-		ImageDB::UIImgQueue.pop_front();
 	}
-
-	while (!TextDB::textDrawQueue.empty()) {
-		auto& tex = TextDB::textDrawQueue.front();
-		auto surf = TTF_RenderText_Solid(tex.font, tex.content.c_str(), tex.color);
-		auto text = SDL_CreateTextureFromSurface(Renderer::renderer_ptr, surf);
-		SDL_FreeSurface(surf);
-		SDL_FRect rect;
-		rect.x = tex.x;
-		rect.y = tex.y;
+	frame.UIImgQueue.clear();
+	Renderer::spriteBatch.Flush(Renderer::renderer_ptr);
+
+	while (!frame.textDrawQueue.empty()) {
+		auto& tex = frame.textDrawQueue.front();
+		if (Renderer::batched) {
+			if (TextCache::AddGlyphs(Renderer::spriteBatch, Renderer::renderer_ptr, tex.font, tex.content, tex.x, tex.y, tex.color)) {
+				frame.textDrawQueue.pop();
+				continue;
+			}
+			// Drawn on its own, so the text batched before it has to reach the screen first.
+			Renderer::spriteBatch.Flush(Renderer::renderer_ptr);
+		}
+
+		auto text = TextCache::StringTexture(Renderer::renderer_ptr, tex.font, tex.content);
+		SDL_FRect rect = { static_cast<float>(tex.x), static_cast<float>(tex.y), 0.0f, 0.0f };
 		Helper::SDL_QueryTexture(text, &rect.w, &rect.h);
+		if (text != nullptr) {
+			SDL_SetTextureColorMod(text, tex.color.r, tex.color.g, tex.color.b);
+			SDL_SetTextureAlphaMod(text, tex.color.a);
+		}
 		Helper::SDL_RenderCopyEx(0, "", Renderer::renderer_ptr, text, NULL, &rect, 0.0f, NULL, SDL_FLIP_NONE);
-		TextDB::textDrawQueue.pop();
+		frame.textDrawQueue.pop();
 	}
+	Renderer::spriteBatch.Flush(Renderer::renderer_ptr);
 
 	SDL_SetRenderDrawBlendMode(Renderer::renderer_ptr, SDL_BLENDMODE_BLEND);
-	while (!ImageDB::pixImgQueue.empty()) {
-		auto& pix = ImageDB::pixImgQueue.front();
+	while (!frame.pixImgQueue.empty()) {
+		auto& pix = frame.pixImgQueue.front();
 		SDL_SetRenderDrawColor(Renderer::renderer_ptr, pix.r, pix.g, pix.b, pix.a);
 		SDL_RenderDrawPoint(Renderer::renderer_ptr, pix.x, pix.y);
 
-		ImageDB::pixImgQueue.pop();
+		frame.pixImgQueue.pop();
 	}
 	SDL_SetRenderDrawBlendMode(Renderer::renderer_ptr, SDL_BLENDMODE_NONE);
 
+	PROFILE_SCOPE("Present");
 	Helper::SDL_RenderPresent(Renderer::renderer_ptr);
 }
\ No newline at end of file
@@ -1,9 +1,38 @@
 #pragma once
+#include "DrawSort.h"
+#include "ImageDB.h"
+#include "SpriteBatch.h"
+#include "TextDB.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "glm/glm.hpp"
 #include "SDL2_Img/SDL_image.h"
 
+/* Everything needed to submit one frame, swapped out of the recording queues at the end of the frame. */
+struct RenderFrame {
+	std::vector<SceneImgStruct> sceneImgQueue;
+	std::vector<UIStruct> UIImgQueue;
+	std::queue<TextStruct> textDrawQueue;
+	std::queue<PixStruct> pixImgQueue;
+	glm::vec2 cameraPos = glm::vec2(0.0f, 0.0f);
+	float renderScale = 1.0f;
+	SDL_Color clearColor = { 255, 255, 255, 255 };
+};
+
+struct RenderTask {
+	const std::function<void()>* work = nullptr;
+	bool done = false;
+};
+
 class Renderer {
 public:
 	static const int UNIT_TO_PIXELS_CONVERSION = 100; // Units are now meters
@@ -15,11 +44,37 @@ public:
 	static glm::ivec2 WINDOW_RESOLUTION;
 	static glm::vec2 cameraPos;
 	static std::string GAME_TITLE;
+	static bool threaded; // Submit frame N on the render thread while frame N+1 simulates; always off on macOS
+	static bool batched; // Draw images and text as textured quads, one geometry call per run of a texture
 
 	static void LuaInit();
 	static void RenderRenderer();
 	static void SetCameraWidth(const int x_resolution);
 	static void SetCameraHeight(const int y_resolution);
+
+	static void StartRenderThread();
+	static void StopRenderThread();
+	static void RunOnRenderThread(const std::function<void()>& task);
+	static void WaitForFrame(); // Blocks until the frame handed to the render thread has been drawn
+	static int GetSubmittedFrames() {
+		return submittedFrames;
+	}
 private:
+	static RenderFrame pendingFrame;
+	static int submittedFrames;
+	static std::thread renderThread;
+	static std::thread::id renderThreadId;
+	static std::mutex renderMutex;
+	static std::condition_variable workSignal;
+	static std::condition_variable idleSignal;
+	static std::deque<RenderTask*> renderTasks;
+	static bool frameReady;
+	static bool renderThreadRunning;
+	static SpriteBatch spriteBatch;
+	static DrawSort drawSort;
+
+	static void CaptureFrame(RenderFrame& frame);
+	static void DrawFrame(RenderFrame& frame);
+	static void RenderThreadLoop();
 	Renderer() {}
 };
\ No newline at end of file
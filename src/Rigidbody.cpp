@@ -1,3 +1,4 @@
+#include "ActorStore.h"
 #include "ComponentDB.h"
 #include "Rigidbody.h"
 #include "SceneDB.h"
@@ -21,8 +22,11 @@ void Rigidbody::OnStart() {
 	bdef.gravityScale = this->gravity_scale;
 	bdef.angularDamping = this->angular_friction;
 	bdef.angle = this->rotation * (b2_pi / 180.0f);
+	bdef.userData.pointer = reinterpret_cast<uintptr_t>(this);
 
 	this->body = SceneDB::world.CreateBody(&bdef);
+	this->previous_position = bdef.position;
+	this->previous_angle = bdef.angle;
 
 	if (!this->has_collider && !this->has_trigger) {
 		b2PolygonShape phantom_shape;
@@ -101,6 +105,16 @@ void Rigidbody::OnStart() {
 	SceneDB::world.SetContactListener(listener);
 }
 
+void Rigidbody::StorePreviousTransforms() {
+	for (b2Body* body = SceneDB::world.GetBodyList(); body != nullptr; body = body->GetNext()) {
+		Rigidbody* rb = reinterpret_cast<Rigidbody*>(body->GetUserData().pointer);
+		if (rb != nullptr) {
+			rb->previous_position = body->GetPosition();
+			rb->previous_angle = body->GetAngle();
+		}
+	}
+}
+
 luabridge::LuaRef Raycast(b2Vec2 pos, b2Vec2 dir, float dist) {
 	b2Vec2 end = pos + (dist * dir);
 	RaycastCallbackSingle callback;
@@ -129,6 +143,19 @@ luabridge::LuaRef RaycastAll(b2Vec2 pos, b2Vec2 dir, float dist) {
 	return actorTable;
 }
 
+// Lua sees actors through handles, never the raw pointers these structs keep for the engine.
+luabridge::LuaRef RigidbodyActor(const Rigidbody* rigidbody) {
+	return ActorStore::ToLua(rigidbody->actor);
+}
+
+luabridge::LuaRef CollisionOther(const Collision* collision) {
+	return ActorStore::ToLua(collision->other);
+}
+
+luabridge::LuaRef HitResultActor(const HitResult* result) {
+	return ActorStore::ToLua(result->actor);
+}
+
 std::string ReturnRigidbodyType() {
 	return "Rigidbody";
 }
@@ -142,6 +169,7 @@ void Rigidbody::LuaInit() {
 		.addProperty("has_trigger", &Rigidbody::has_trigger)
 		.addProperty("enabled", &Rigidbody::enabled)
 		.addProperty("removed", &Rigidbody::removed)
+		.addProperty("interpolate", &Rigidbody::interpolate)
 		.addProperty("x", &Rigidbody::x)
 		.addProperty("y", &Rigidbody::y)
 		.addProperty("gravity_scale", &Rigidbody::gravity_scale)
@@ -157,7 +185,7 @@ void Rigidbody::LuaInit() {
 		.addProperty("friction", &Rigidbody::friction)
 		.addProperty("bounciness", &Rigidbody::bounciness)
 		.addProperty("body", &Rigidbody::body)
-		.addProperty("actor", &Rigidbody::actor)
+		.addProperty("actor", &RigidbodyActor)
 		.addProperty("body_type", &Rigidbody::body_type)
 		.addProperty("collider_type", &Rigidbody::collider_type)
 		.addProperty("trigger_type", &Rigidbody::trigger_type)
@@ -165,6 +193,8 @@ void Rigidbody::LuaInit() {
 		.addProperty("type", &Rigidbody::type)
 		.addFunction("GetPosition", &Rigidbody::GetPosition)
 		.addFunction("GetRotation", &Rigidbody::GetRotation)
+		.addFunction("GetRenderPosition", &Rigidbody::GetRenderPosition)
+		.addFunction("GetRenderRotation", &Rigidbody::GetRenderRotation)
 		.addFunction("OnStart", &Rigidbody::OnStart)
 		.addFunction("OnDestroy", &Rigidbody::OnDestroy)
 		.addFunction("AddForce", &Rigidbody::AddForce)
@@ -184,14 +214,14 @@ void Rigidbody::LuaInit() {
 		.endClass();
 	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
 		.beginClass<Collision>("Collision")
-		.addProperty("other", &Collision::other)
+		.addProperty("other", &CollisionOther)
 		.addProperty("point", &Collision::point)
 		.addProperty("relative_velocity", &Collision::relative_velocity)
 		.addProperty("normal", &Collision::normal)
 		.endClass();
 	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
 		.beginClass<HitResult>("HitResult")
-		.addProperty("actor", &HitResult::actor)
+		.addProperty("actor", &HitResultActor)
 		.addProperty("point", &HitResult::point)
 		.addProperty("normal", &HitResult::normal)
 		.addProperty("is_trigger", &HitResult::is_trigger)
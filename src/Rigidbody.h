@@ -1,6 +1,10 @@
 #pragma once
 #include "Actor.h"
+#include "HookTable.h"
+#include "Profiler.h"
 #include "SceneDB.h"
+#include "SpatialIndex.h"
+#include "Time.h"
 
 #include <algorithm>
 #include <string>
@@ -18,6 +22,7 @@ public:
 	bool has_trigger = true;
 	bool enabled = true;
 	bool removed = false;
+	bool interpolate = false;
 	float x = 0.0f;
 	float y = 0.0f;
 	float gravity_scale = 1.0f;
@@ -32,6 +37,8 @@ public:
 	float trigger_radius = 0.5f;
 	float friction = 0.3f;
 	float bounciness = 0.3f;
+	float previous_angle = 0.0f;
+	b2Vec2 previous_position = b2Vec2(0.0f, 0.0f);
 	b2Body* body = nullptr;
 	Actor* actor = nullptr;
 	std::string body_type = "dynamic";
@@ -45,6 +52,7 @@ public:
 		precise = rb->precise;
 		has_collider = rb->has_collider;
 		has_trigger = rb->has_trigger;
+		interpolate = rb->interpolate;
 		x = rb->x;
 		y = rb->y;
 		gravity_scale = rb->gravity_scale;
@@ -82,6 +90,23 @@ public:
 			return this->rotation;
 		}
 	}
+	// For draw code only: with interpolate set, the pose blended between the last two ticks.
+	b2Vec2 GetRenderPosition() {
+		if (this->body && this->interpolate) {
+			b2Vec2 current = this->body->GetPosition();
+			float alpha = Time::interpolationAlpha;
+			return b2Vec2(glm::mix(this->previous_position.x, current.x, alpha),
+				glm::mix(this->previous_position.y, current.y, alpha));
+		}
+		return this->GetPosition();
+	}
+	float GetRenderRotation() {
+		if (this->body && this->interpolate) {
+			float radians = glm::mix(this->previous_angle, this->body->GetAngle(), Time::interpolationAlpha);
+			return radians * (180.0f / b2_pi);
+		}
+		return this->GetRotation();
+	}
 	void AddForce(b2Vec2 f) {
 		this->body->ApplyForceToCenter(f, true);
 	}
@@ -89,8 +114,10 @@ public:
 		this->body->SetLinearVelocity(v);
 	}
 	void SetPosition(const b2Vec2& pos) {
+		SpatialIndex::Touch(this->actor);
 		if (this->body) {
 			this->body->SetTransform(pos, this->body->GetAngle());
+			this->previous_position = pos;
 		}
 		else {
 			this->x = pos.x;
@@ -101,6 +128,7 @@ public:
 		if (this->body) {
 			float radians = degrees * (b2_pi / 180.0f);
 			this->body->SetTransform(this->body->GetPosition(), radians);
+			this->previous_angle = radians;
 		}
 		else {
 			this->rotation = degrees;
@@ -186,6 +214,7 @@ public:
 	void OnDestroy() {
 		SceneDB::world.DestroyBody(this->body);
 	}
+	static void StorePreviousTransforms();
 	static void LuaInit();
 };
 
@@ -215,17 +244,21 @@ public:
 			collision_a.normal = manifold.normal;
 			collision_b.normal = manifold.normal;
 
-			for (auto component : collision_b.other->collisionEnterComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_COLLISION_ENTER, collision_b.other)) {
+				ProfileScope scope("OnCollisionEnter");
+				ComponentDB::TagScope(scope, collision_b.other, *entry.component);
 				try {
-					(*component)["OnCollisionEnter"](*component, collision_a);
+					entry.component->Invoke(HOOK_COLLISION_ENTER, collision_a);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_b.other->GetName(), e);
 				}
 			}
-			for (auto component : collision_a.other->collisionEnterComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_COLLISION_ENTER, collision_a.other)) {
+				ProfileScope scope("OnCollisionEnter");
+				ComponentDB::TagScope(scope, collision_a.other, *entry.component);
 				try {
-					(*component)["OnCollisionEnter"](*component, collision_b);
+					entry.component->Invoke(HOOK_COLLISION_ENTER, collision_b);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_a.other->GetName(), e);
@@ -233,17 +266,21 @@ public:
 			}
 		}
 		else {
-			for (auto component : collision_b.other->triggerEnterComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_TRIGGER_ENTER, collision_b.other)) {
+				ProfileScope scope("OnTriggerEnter");
+				ComponentDB::TagScope(scope, collision_b.other, *entry.component);
 				try {
-					(*component)["OnTriggerEnter"](*component, collision_a);
+					entry.component->Invoke(HOOK_TRIGGER_ENTER, collision_a);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_b.other->GetName(), e);
 				}
 			}
-			for (auto component : collision_a.other->triggerEnterComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_TRIGGER_ENTER, collision_a.other)) {
+				ProfileScope scope("OnTriggerEnter");
+				ComponentDB::TagScope(scope, collision_a.other, *entry.component);
 				try {
-					(*component)["OnTriggerEnter"](*component, collision_b);
+					entry.component->Invoke(HOOK_TRIGGER_ENTER, collision_b);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_a.other->GetName(), e);
@@ -262,17 +299,21 @@ public:
 		collision_b.relative_velocity = collision_a.relative_velocity;
 
 		if (fixture_a->GetFilterData().categoryBits == COLLIDER_CATEGORY) {
-			for (auto component : collision_b.other->collisionExitComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_COLLISION_EXIT, collision_b.other)) {
+				ProfileScope scope("OnCollisionExit");
+				ComponentDB::TagScope(scope, collision_b.other, *entry.component);
 				try {
-					(*component)["OnCollisionExit"](*component, collision_a);
+					entry.component->Invoke(HOOK_COLLISION_EXIT, collision_a);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_b.other->GetName(), e);
 				}
 			}
-			for (auto component : collision_a.other->collisionExitComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_COLLISION_EXIT, collision_a.other)) {
+				ProfileScope scope("OnCollisionExit");
+				ComponentDB::TagScope(scope, collision_a.other, *entry.component);
 				try {
-					(*component)["OnCollisionExit"](*component, collision_b);
+					entry.component->Invoke(HOOK_COLLISION_EXIT, collision_b);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_a.other->GetName(), e);
@@ -280,17 +321,21 @@ public:
 			}
 		}
 		else {
-			for (auto component : collision_b.other->triggerExitComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_TRIGGER_EXIT, collision_b.other)) {
+				ProfileScope scope("OnTriggerExit");
+				ComponentDB::TagScope(scope, collision_b.other, *entry.component);
 				try {
-					(*component)["OnTriggerExit"](*component, collision_a);
+					entry.component->Invoke(HOOK_TRIGGER_EXIT, collision_a);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_b.other->GetName(), e);
 				}
 			}
-			for (auto component : collision_a.other->triggerExitComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_TRIGGER_EXIT, collision_a.other)) {
+				ProfileScope scope("OnTriggerExit");
+				ComponentDB::TagScope(scope, collision_a.other, *entry.component);
 				try {
-					(*component)["OnTriggerExit"](*component, collision_b);
+					entry.component->Invoke(HOOK_TRIGGER_EXIT, collision_b);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(collision_a.other->GetName(), e);
@@ -363,4 +408,4 @@ public:
 			});
 	}
 private:
-};
+};
\ No newline at end of file
@@ -1,12 +1,21 @@
 #include "Actor.h"
+#include "ActorPool.h"
+#include "ActorStore.h"
 #include "ComponentDB.h"
+#include "CookedScene.h"
 #include "DataManager.h"
 #include "EngineUtils.h"
+#include "HookTable.h"
+#include "LuaHeap.h"
 #include "ParticleSystem.h"
 #include "Rigidbody.h"
 #include "SceneDB.h"
+#include "SceneLoader.h"
+#include "SpatialIndex.h"
 #include "TemplateDB.h"
+#include "TextureAtlas.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <stdexcept>
@@ -39,114 +48,138 @@ bool actorExists(const std::string& actorName, const int actorID) {
 	return false;
 }
 
-luabridge::LuaRef Find(const std::string& name) {
-	try {
-		luabridge::LuaRef actorRef = luabridge::newTable(ComponentDB::GetLuaState());
-		actorRef = &*SceneDB::namedActors.at(name).at(0);
-		return actorRef;
+void DeleteActor(Actor* actor) {
+	if (!actor->typedComponents["Rigidbody"].empty()) {
+		for (auto& component : actor->typedComponents["Rigidbody"]) {
+			auto bd = (*component).cast<Rigidbody*>();
+			delete bd;
+		}
 	}
-	catch (const std::out_of_range&) {
-		return luabridge::LuaRef(ComponentDB::GetLuaState());
+
+	if (!actor->typedComponents["ParticleSystem"].empty()) {
+		for (auto& component : actor->typedComponents["ParticleSystem"]) {
+			auto bd = (*component).cast<ParticleSystem*>();
+			delete bd;
+		}
 	}
+
+	delete actor;
+}
+
+luabridge::LuaRef Find(const std::string& name) {
+	auto it = SceneDB::namedActors.find(name);
+	if (it != SceneDB::namedActors.end()) {
+		for (auto actor : it->second) {
+			if (!actor->removed) {
+				return ActorStore::ToLua(actor);
+			}
+		}
+	}
+	return luabridge::LuaRef(ComponentDB::GetLuaState());
 }
 
 luabridge::LuaRef FindAll(const std::string& name) {
 	luabridge::LuaRef actorTable = luabridge::newTable(ComponentDB::GetLuaState());
 	int iter = 1;
 
-	try {
-		auto& vec = SceneDB::namedActors.at(name);
-		for (auto actor : vec) {
-			actorTable[iter] = &*actor;
-			iter++;
+	auto it = SceneDB::namedActors.find(name);
+	if (it != SceneDB::namedActors.end()) {
+		for (auto actor : it->second) {
+			if (!actor->removed) {
+				actorTable[iter] = actor->handle;
+				iter++;
+			}
 		}
 	}
-	catch (const std::out_of_range&) {
-		return actorTable;
-	}
 
 	return actorTable;
 }
 
-luabridge::LuaRef Instantiate(const std::string& actor_template_name) {
-	if (SceneDB::nowClearing) {
-		if (!TemplateDB::DoesntDestroyOnLoad(actor_template_name)) {
-			return luabridge::LuaRef(ComponentDB::GetLuaState());
-		}
-		else {
-			Actor* tempActor = new Actor();
-			TemplateDB::LoadTemplate(*tempActor, actor_template_name);
-			(*tempActor).SetID(SceneDB::UUID);
-			SceneDB::UUID++;
-
-			SceneDB::retainedActors.push_back(tempActor);
-			SceneDB::ActorInsertSort(SceneDB::retainedActors);
+// Whether an actor spawned from OnDestroy during a scene load's teardown would outlive it. The teardown
+// sweeps its snapshot once, so anything it would have destroyed is never spawned in the first place.
+static bool SurvivesClearing(const std::string& actor_template_name) {
+	return !DataManager::loadingSave && TemplateDB::DoesntDestroyOnLoad(actor_template_name);
+}
 
-			luabridge::LuaRef actorRef = luabridge::newTable(ComponentDB::GetLuaState());
-			actorRef = &*tempActor;
-			return actorRef;
-		}
+luabridge::LuaRef Instantiate(const std::string& actor_template_name) {
+	if (SceneDB::nowClearing && !SurvivesClearing(actor_template_name)) {
+		return luabridge::LuaRef(ComponentDB::GetLuaState());
 	}
 
-	Actor* tempActor = new Actor();
-	TemplateDB::LoadTemplate(*tempActor, actor_template_name);
+	Actor* tempActor = ActorPool::Acquire(actor_template_name);
 	(*tempActor).SetID(SceneDB::UUID);
 	SceneDB::UUID++;
 
-	SceneDB::actors.push_back(tempActor);
-	SceneDB::namedActors[(*tempActor).GetName()].push_back(tempActor);
-	SceneDB::addedActors.push_back(tempActor);
-
-	luabridge::LuaRef actorRef = luabridge::newTable(ComponentDB::GetLuaState());
-	actorRef = &*tempActor;
-	return actorRef;
-}
-
-Actor* RefToPointer(std::vector<Actor*> actors, Actor& target) {
-	for (auto actor : actors) {
-		if ((*actor).GetID() == target.GetID()) {
-			return actor;
-		}
+	if (!SceneDB::nowClearing) {
+		// Mid-load, LoadScene files the survivors under their names once the old scene is gone.
+		SceneDB::namedActors[(*tempActor).GetName()].push_back(tempActor);
 	}
-	return nullptr;
+	HookTable::RegisterActor(tempActor);
+
+	return ActorStore::ToLua(tempActor);
 }
 
-void Destroy(Actor* actor) {
+void Destroy(ActorHandle* handle) {
+	Actor* actor = handle != nullptr ? handle->Get() : nullptr;
 	if (actor == nullptr) return;
 	if (actor->removed) return;
 	if (SceneDB::nowClearing && !actor->dontDestroyOnLoad) return;
 	actor->removed = true;
-	if (auto it = std::find(SceneDB::addedActors.begin(), SceneDB::addedActors.end(), actor);
-		it != SceneDB::addedActors.end()) {
-		SceneDB::addedActors.erase(it);
-	}
 
 	for (auto& component : actor->keyedComponents) {
 		(*component.second)["enabled"] = false;
 	}
 
-	
-	{
-		if (std::find(SceneDB::namedActors[actor->GetName()].begin(),
-			SceneDB::namedActors[actor->GetName()].end(), actor)
-			!= SceneDB::namedActors[actor->GetName()].end()) {
-			SceneDB::namedActors[actor->GetName()].erase(
-				std::find(SceneDB::namedActors[actor->GetName()].begin(),
-				SceneDB::namedActors[actor->GetName()].end(), actor));
-		}
+	// The removed flag already hides it from Find; RemoveActors drops it from namedActors.
+	if (!SceneDB::nowRemoving) {
+		SceneDB::removedActors.push_back(actor->handle);
+	}
+	else {
+		SceneDB::willRemoveActors.push_back(actor->handle);
 	}
+}
 
-	if (!SceneDB::nowRemoving) {
-		if (std::find(SceneDB::removedActors.begin(),
-			SceneDB::removedActors.end(), actor)
-			== SceneDB::removedActors.end()) {
-			SceneDB::removedActors.push_back(actor);
+luabridge::LuaRef InstantiateMany(const std::string& actor_template_name, int count) {
+	lua_State* L = ComponentDB::GetLuaState();
+	lua_createtable(L, count > 0 ? count : 0, 0);
+	luabridge::LuaRef actorTable = luabridge::LuaRef::fromStack(L, -1);
+	lua_pop(L, 1);
+	if (count <= 0 || (SceneDB::nowClearing && !SurvivesClearing(actor_template_name))) {
+		return actorTable;
+	}
+
+	ActorStore::Reserve(count);
+	std::vector<Actor*>* named = nullptr;
+	for (int i = 1; i <= count; i++) {
+		Actor* tempActor = ActorPool::Acquire(actor_template_name);
+		(*tempActor).SetID(SceneDB::UUID);
+		SceneDB::UUID++;
+
+		// Every copy shares the template's name and gets a higher ID than anything before it,
+		// so they all append to one bucket in dispatch order.
+		if (!SceneDB::nowClearing) {
+			if (named == nullptr) {
+				named = &SceneDB::namedActors[(*tempActor).GetName()];
+				named->reserve(named->size() + count);
+			}
+			named->push_back(tempActor);
 		}
+		HookTable::RegisterActor(tempActor);
+		actorTable[i] = tempActor->handle;
 	}
-	else {
-		auto& vec = SceneDB::willRemoveActors;
-		if (std::find(vec.begin(), vec.end(), actor) == vec.end()) {
-			SceneDB::willRemoveActors.push_back(actor);
+
+	return actorTable;
+}
+
+void DestroyMany(luabridge::LuaRef actors) {
+	if (!actors.isTable()) return;
+	int count = actors.length();
+	auto& queue = SceneDB::nowRemoving ? SceneDB::willRemoveActors : SceneDB::removedActors;
+	queue.reserve(queue.size() + count);
+	for (int i = 1; i <= count; i++) {
+		luabridge::LuaRef entry = actors[i];
+		if (entry.isInstance<ActorHandle>()) {
+			Destroy(entry.cast<ActorHandle*>());
 		}
 	}
 }
@@ -159,8 +192,39 @@ std::string GetCurrent() {
 	return SceneDB::currentScene;
 }
 
-void DontDestroy(Actor* actor) {
-	actor->dontDestroyOnLoad = true;
+void QueueAdditive(const std::string& scene_name) {
+	if (SceneDB::subScenes.find(scene_name) == SceneDB::subScenes.end() && std::find(SceneDB::pendingAdditive.begin(),
+		SceneDB::pendingAdditive.end(), scene_name) == SceneDB::pendingAdditive.end()) {
+		SceneDB::pendingAdditive.push_back(scene_name);
+	}
+}
+
+bool IsLoaded(const std::string& scene_name) {
+	return scene_name == SceneDB::currentScene || SceneDB::subScenes.find(scene_name) != SceneDB::subScenes.end();
+}
+
+luabridge::LuaRef GetActors(const std::string& scene_name) {
+	luabridge::LuaRef actorTable = luabridge::newTable(ComponentDB::GetLuaState());
+	int iter = 1;
+
+	auto it = SceneDB::subScenes.find(scene_name);
+	if (it != SceneDB::subScenes.end()) {
+		for (auto& handle : it->second) {
+			Actor* actor = handle.Get();
+			if (actor != nullptr && !actor->removed) {
+				actorTable[iter] = handle;
+				iter++;
+			}
+		}
+	}
+
+	return actorTable;
+}
+
+void DontDestroy(ActorHandle* handle) {
+	if (Actor* actor = handle != nullptr ? handle->Get() : nullptr) {
+		actor->dontDestroyOnLoad = true;
+	}
 }
 
 void Subscribe(const std::string& event_type, luabridge::LuaRef component, luabridge::LuaRef function) {
@@ -190,12 +254,20 @@ void SceneDB::LuaInit() {
 		.addFunction("FindAll", &FindAll)
 		.addFunction("Instantiate", &Instantiate)
 		.addFunction("Destroy", &Destroy)
+		.addFunction("InstantiateMany", &InstantiateMany)
+		.addFunction("DestroyMany", &DestroyMany)
+		.addFunction("Prewarm", &ActorPool::Prewarm)
+		.addFunction("GetPoolStats", &ActorPool::GetStats)
 		.endNamespace();
 	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
 		.beginNamespace("Scene")
 		.addFunction("Load", &Load)
 		.addFunction("GetCurrent", &GetCurrent)
 		.addFunction("DontDestroy", &DontDestroy)
+		.addFunction("LoadAdditive", &QueueAdditive)
+		.addFunction("Unload", &SceneDB::UnloadAdditive)
+		.addFunction("IsLoaded", &IsLoaded)
+		.addFunction("GetActors", &GetActors)
 		.endNamespace();
 	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
 		.beginNamespace("Event")
@@ -225,7 +297,7 @@ bool IsInherited(Actor* actor, std::string key,
 	}
 }
 
-void SceneDB::LoadScene(std::string& sceneName) {
+std::string SceneDB::ScenePath(const std::string& sceneName) {
 	if (sceneName == "system") {
 		std::cout << "error: scene name \"system\" is reserved by engine. rename scene.";
 		std::exit(0);
@@ -236,13 +308,29 @@ void SceneDB::LoadScene(std::string& sceneName) {
 		std::cout << "error: scene " + sceneName + " is missing";
 		std::exit(0); 
 	}
+	return scenePath;
+}
+
+void SceneDB::LoadScene(std::string& sceneName) {
+	std::string scenePath = SceneDB::ScenePath(sceneName);
+	CookedFile cooked;
+	if (cooked.Open(CookedScene::ScenePath(sceneName), COOKED_SCENE)) {
+		SceneDB::LoadScene(sceneName, cooked);
+		return;
+	}
+
+	rapidjson::Document sceneJson;
+	ReadJsonFile(scenePath, sceneJson);
+	SceneDB::LoadScene(sceneName, sceneJson);
+}
 
-	SceneDB::startingActors.clear();
-	SceneDB::updatingActors.clear();
-	SceneDB::lateUpdatingActors.clear();
+void SceneDB::BeginSceneLoad(std::string& sceneName) {
+	// Actors instantiated since the last AddActors still need their OnDestroy hooks found below.
+	HookTable::Flush();
 	SceneDB::namedActors.clear();
-	SceneDB::compAddedActors.clear();
-	SceneDB::compRemovedActors.clear();
+	SceneDB::subScenes.clear(); // Sub-scenes belong to the scene they were added to
+	SceneDB::compAddedActors.Clear();
+	SceneDB::compRemovedActors.Clear();
 
 	if (!DataManager::loadingSave) {
 		DataManager::SaveScene();
@@ -250,120 +338,84 @@ void SceneDB::LoadScene(std::string& sceneName) {
 	SceneDB::sceneSaveActors.clear();
 
 	SceneDB::nowClearing = true;
-	for (auto actor : SceneDB::actors) {
+	// The store is unordered, so sort a snapshot: OnDestroy runs in the same order as every other hook.
+	for (auto actor : ActorStore::LiveInOrder()) {
 		if (!actor->dontDestroyOnLoad || DataManager::loadingSave) {
-			for (auto& component : actor->destroyingComponents) {
+			for (auto& entry : HookTable::ActorEntries(HOOK_DESTROY, actor)) {
+				ProfileScope scope("OnDestroy");
+				ComponentDB::TagScope(scope, actor, *entry.component);
 				try {
-					(*component)["OnDestroy"](*component);
+					entry.component->Invoke(HOOK_DESTROY);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(actor->GetName(), e);
 				}
 			}
+			HookTable::UnregisterActor(actor);
 
-			if (!actor->typedComponents["Rigidbody"].empty()) {
-				for (auto& component : actor->typedComponents["Rigidbody"]) {
-					auto bd = (*component).cast<Rigidbody*>();
-					delete bd;
-				}
-			}
-
-			if (!actor->typedComponents["ParticleSystem"].empty()) {
-				for (auto& component : actor->typedComponents["ParticleSystem"]) {
-					auto bd = (*component).cast<ParticleSystem*>();
-					delete bd;
-				}
-			}
-
-			auto& vec = SceneDB::willRemoveActors;
-			if (auto it = std::find(vec.begin(), vec.end(), actor); it != vec.end()) {
-				vec.erase(it);
-			}
-
-			vec = SceneDB::addedActors;
-			if (auto it = std::find(vec.begin(), vec.end(), actor); it != vec.end()) {
-				vec.erase(it);
+			// Handles left in the removal queues simply go stale.
+			ActorStore::Erase(actor);
+			if (!ActorPool::Release(actor)) {
+				DeleteActor(actor);
 			}
-
-			vec = SceneDB::removedActors;
-			if (auto it = std::find(vec.begin(), vec.end(), actor); it != vec.end()) {
-				vec.erase(it);
-			}
-
-			delete actor;
-		}
-		else {
-			SceneDB::retainedActors.push_back(actor);
-			SceneDB::ActorInsertSort(SceneDB::retainedActors);
 		}
 	}
 	SceneDB::nowClearing = false;
 
-	SceneDB::actors.clear();
-	if (DataManager::loadingSave) {
-		SceneDB::retainedActors.clear();
-	}
+	// Whatever is left was kept for the new scene.
 	SceneDB::systemSaveActors.clear();
-	for (auto actor : SceneDB::retainedActors) {
+	for (auto actor : ActorStore::LiveInOrder()) {
 		SceneDB::namedActors[actor->GetName()].push_back(actor);
 
-		if (!(*actor).startingComponents.empty()) {
-			SceneDB::startingActors.push_back(actor);
-		}
-		if (!(*actor).updatingComponents.empty()) {
-			SceneDB::updatingActors.push_back(actor);
-		}
-		if (!(*actor).lateUpdatingComponents.empty()) {
-			SceneDB::lateUpdatingActors.push_back(actor);
-		}
 		if (!(*actor).addedComponents.empty()) {
-			SceneDB::compAddedActors.push_back(actor);
+			SceneDB::compAddedActors.Insert(actor);
 		}
 		if (!(*actor).removedComponents.empty()) {
-			SceneDB::compRemovedActors.push_back(actor);
+			SceneDB::compRemovedActors.Insert(actor);
 		}
 
 		if (actor->save_type == SAVE_SYSTEM) {
 			SceneDB::systemSaveActors.push_back(actor);
 		}
 	}
-	for (auto actor : SceneDB::addedActors) {
-		SceneDB::namedActors[actor->GetName()].push_back(actor);
-		SceneDB::ActorInsertSort(SceneDB::namedActors[actor->GetName()]);
-
-		if (!(*actor).startingComponents.empty()) {
-			SceneDB::startingActors.push_back(actor);
-			SceneDB::ActorInsertSort(SceneDB::startingActors);
-		}
-		if (!(*actor).updatingComponents.empty()) {
-			SceneDB::updatingActors.push_back(actor);
-			SceneDB::ActorInsertSort(SceneDB::updatingActors);
-		}
-		if (!(*actor).lateUpdatingComponents.empty()) {
-			SceneDB::lateUpdatingActors.push_back(actor);
-			SceneDB::ActorInsertSort(SceneDB::lateUpdatingActors);
-		}
-		if (!(*actor).addedComponents.empty()) {
-			SceneDB::compAddedActors.push_back(actor);
-			SceneDB::ActorInsertSort(SceneDB::compAddedActors);
-		}
-		if (!(*actor).removedComponents.empty()) {
-			SceneDB::compRemovedActors.push_back(actor);
-			SceneDB::ActorInsertSort(SceneDB::compRemovedActors);
-		}
-	}
 	
 	DataManager::loadingSave = false;
 	SceneDB::currentScene = sceneName;
 	SceneDB::nextScene = "";
+	TextureAtlas::UseScene(sceneName);
 	SceneDB::UUID = 0;
-	rapidjson::Document sceneJson;
-	ReadJsonFile(scenePath, sceneJson);
+	HookTable::NextEpoch();
+}
+
+void SceneDB::EndSceneLoad() {
+	DataManager::LoadScene();
+	DataManager::LoadSystem();
+
+	HookTable::Compact();
+	HookTable::Flush();
+
+	// The old scene's tables are all garbage now; pay for them here rather than mid-gameplay.
+	LuaHeap::FullCollect(ComponentDB::GetLuaState());
+}
+
+void SceneDB::LoadScene(std::string& sceneName, rapidjson::Document& sceneJson) {
+	SceneDB::BeginSceneLoad(sceneName);
+	SceneDB::LoadActors(sceneJson, nullptr);
+	SceneDB::EndSceneLoad();
+}
 
+void SceneDB::LoadScene(std::string& sceneName, const CookedFile& scene) {
+	SceneDB::BeginSceneLoad(sceneName);
+	SceneDB::LoadActors(scene, nullptr);
+	SceneDB::EndSceneLoad();
+}
+
+void SceneDB::LoadActors(rapidjson::Document& sceneJson, std::vector<ActorHandle>* loaded) {
 	rapidjson::GenericArray sceneActors = sceneJson["actors"].GetArray();
 
 	for (auto& actor : sceneActors) {
 		Actor* tempActor = new Actor();
+		ActorStore::Insert(tempActor);
 
 		if (actor.HasMember("template")) {
 			TemplateDB::LoadTemplate(*tempActor, std::string(actor["template"].GetString()));
@@ -377,6 +429,7 @@ void SceneDB::LoadScene(std::string& sceneName) {
 		SceneDB::UUID++;
 
 		if (actorExists(tempActor->GetName(), tempActor->GetID())) {
+			ActorStore::Erase(tempActor);
 			delete tempActor;
 			continue;
 		}
@@ -400,175 +453,153 @@ void SceneDB::LoadScene(std::string& sceneName) {
 			}
 		}
 
-		SceneDB::actors.push_back(tempActor);
 		SceneDB::namedActors[(*tempActor).GetName()].push_back(tempActor);
-		if (!(*tempActor).startingComponents.empty()) {
-			SceneDB::startingActors.push_back(tempActor);
-		}
-		if (!(*tempActor).updatingComponents.empty()) {
-			SceneDB::updatingActors.push_back(tempActor);
-		}
-		if (!(*tempActor).lateUpdatingComponents.empty()) {
-			SceneDB::lateUpdatingActors.push_back(tempActor);
+		HookTable::RegisterActor(tempActor);
+		if (loaded != nullptr) {
+			loaded->push_back(tempActor->handle);
 		}
 	}
-
-	DataManager::LoadScene();
-	DataManager::LoadSystem();
 }
 
-void SceneDB::ActorInsertSort(std::vector<Actor*>& actors) {
-	for (size_t iter = actors.size() - 1; iter > 0; iter--) {
-		if (actors[iter]->GetID() < actors[iter - 1]->GetID()) {
-			Actor* temp = actors[iter];
-			actors[iter] = actors[iter - 1];
-			actors[iter - 1] = temp;
+void SceneDB::LoadActors(const CookedFile& scene, std::vector<ActorHandle>* loaded) {
+	for (uint32_t i = 0; i < scene.ActorCount(); i++) {
+		const CookedActor& actor = scene.ActorAt(i);
+		Actor* tempActor = new Actor();
+		ActorStore::Insert(tempActor);
+
+		if (actor.templateName != COOKED_NONE) {
+			TemplateDB::LoadTemplate(*tempActor, scene.String(actor.templateName));
 		}
-		else {
-			break;
+
+		if (actor.name != COOKED_NONE) {
+			(*tempActor).SetName(scene.String(actor.name));
 		}
-	}
-}
 
-void SceneDB::AddComponents() {
-	for (auto actor : SceneDB::compAddedActors) {
-		for (auto& component : actor->addedComponents) {
-			if (!(*component)["removed"].cast<bool>()) {
-				actor->keyedComponents.insert(
-					std::pair((*component)["key"].cast<std::string>(), component));
-				actor->typedComponents[(*component)["type"].cast<std::string>()].push_back(component);
+		(*tempActor).SetID(SceneDB::UUID);
+		SceneDB::UUID++;
 
-				if ((*component)["OnStart"].isFunction()) {
-					actor->startingComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->startingComponents);
-				}
+		if (actorExists(tempActor->GetName(), tempActor->GetID())) {
+			ActorStore::Erase(tempActor);
+			delete tempActor;
+			continue;
+		}
 
-				if ((*component)["OnUpdate"].isFunction()) {
-					actor->updatingComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->updatingComponents);
+		// The cooker already split inherited components from new ones.
+		for (uint32_t c = 0; c < actor.componentCount; c++) {
+			const CookedComponent& component = scene.ComponentAt(actor.firstComponent + c);
+			if (component.type == COOKED_NONE) {
+				auto inherited = tempActor->keyedComponents.find(scene.String(component.key));
+				if (inherited != tempActor->keyedComponents.end()) {
+					ComponentDB::LoadCookedOverrides(*inherited->second, scene, component);
 				}
+			}
+			else {
+				ComponentDB::LoadCookedComponent(tempActor, scene, component);
+			}
+		}
 
-				if ((*component)["OnLateUpdate"].isFunction()) {
-					actor->lateUpdatingComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->lateUpdatingComponents);
-				}
+		SceneDB::namedActors[(*tempActor).GetName()].push_back(tempActor);
+		HookTable::RegisterActor(tempActor);
+		if (loaded != nullptr) {
+			loaded->push_back(tempActor->handle);
+		}
+	}
+}
 
-				if ((*component)["OnDestroy"].isFunction()) {
-					actor->destroyingComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->destroyingComponents);
-				}
+void SceneDB::LoadAdditive(const std::string& sceneName) {
+	std::string scenePath = SceneDB::ScenePath(sceneName);
+	CookedFile cooked;
+	if (cooked.Open(CookedScene::ScenePath(sceneName), COOKED_SCENE)) {
+		SceneDB::LoadAdditive(sceneName, cooked);
+		return;
+	}
 
-				if ((*component)["OnCollisionEnter"].isFunction()) {
-					actor->collisionEnterComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->collisionEnterComponents);
-				}
+	rapidjson::Document sceneJson;
+	ReadJsonFile(scenePath, sceneJson);
+	SceneDB::LoadAdditive(sceneName, sceneJson);
+}
 
-				if ((*component)["OnCollisionExit"].isFunction()) {
-					actor->collisionExitComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->collisionExitComponents);
-				}
+void SceneDB::LoadAdditive(const std::string& sceneName, rapidjson::Document& sceneJson) {
+	if (SceneDB::subScenes.find(sceneName) != SceneDB::subScenes.end()) {
+		return;
+	}
+	std::vector<ActorHandle>& loaded = SceneDB::subScenes[sceneName];
+	SceneDB::LoadActors(sceneJson, &loaded);
+	// Runs where a scene load would, so the new actors start this frame like a loaded scene's do.
+	HookTable::Flush();
+}
 
-				if ((*component)["OnTriggerEnter"].isFunction()) {
-					actor->triggerEnterComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->triggerEnterComponents);
-				}
+void SceneDB::LoadAdditive(const std::string& sceneName, const CookedFile& scene) {
+	if (SceneDB::subScenes.find(sceneName) != SceneDB::subScenes.end()) {
+		return;
+	}
+	std::vector<ActorHandle>& loaded = SceneDB::subScenes[sceneName];
+	SceneDB::LoadActors(scene, &loaded);
+	HookTable::Flush();
+}
 
-				if ((*component)["OnTriggerExit"].isFunction()) {
-					actor->triggerExitComponents.push_back(component);
-					ComponentDB::ComponentInsertSort(actor->triggerExitComponents);
-				}
-			}
-		}
+void SceneDB::LoadPendingAdditive() {
+	std::vector<std::string> pending;
+	pending.swap(SceneDB::pendingAdditive);
+	for (auto& sceneName : pending) {
+		SceneDB::LoadAdditive(sceneName);
+	}
+}
 
-		actor->addedComponents.clear();
-		auto& vec = SceneDB::addedActors;
-		if (std::find(vec.begin(), vec.end(), actor) == vec.end()) {
-			if (!actor->startingComponents.empty()) {
-				SceneDB::startingActors.push_back(actor);
-				SceneDB::ActorInsertSort(SceneDB::startingActors);
-			}
+void SceneDB::UnloadAdditive(const std::string& sceneName) {
+	auto queued = std::find(SceneDB::pendingAdditive.begin(), SceneDB::pendingAdditive.end(), sceneName);
+	if (queued != SceneDB::pendingAdditive.end()) {
+		SceneDB::pendingAdditive.erase(queued);
+	}
+	SceneLoader::CancelAdditive(sceneName);
 
-			if (!actor->updatingComponents.empty()) {
-				if (std::find(SceneDB::updatingActors.begin(),
-					SceneDB::updatingActors.end(), actor) == SceneDB::updatingActors.end()) {
-					SceneDB::updatingActors.push_back(actor);
-					SceneDB::ActorInsertSort(SceneDB::updatingActors);
-				}
-			}
+	auto it = SceneDB::subScenes.find(sceneName);
+	if (it == SceneDB::subScenes.end()) {
+		return;
+	}
+	// Destroyed the usual way, so OnDestroy runs in RemoveActors. Actors marked DontDestroy have left the sub-scene.
+	std::vector<ActorHandle> loaded;
+	loaded.swap(it->second);
+	SceneDB::subScenes.erase(it);
+	for (auto& handle : loaded) {
+		Actor* actor = handle.Get();
+		if (actor != nullptr && !actor->dontDestroyOnLoad) {
+			Destroy(&handle);
+		}
+	}
+}
 
-			if (!actor->lateUpdatingComponents.empty()) {
-				if (std::find(SceneDB::lateUpdatingActors.begin(),
-					SceneDB::lateUpdatingActors.end(), actor) == SceneDB::lateUpdatingActors.end()) {
-					SceneDB::lateUpdatingActors.push_back(actor);
-					SceneDB::ActorInsertSort(SceneDB::lateUpdatingActors);
-				}
+void SceneDB::AddComponents() {
+	for (auto actor : SceneDB::compAddedActors.Take()) {
+		for (auto& component : actor->addedComponents) {
+			if (!(*component)["removed"].cast<bool>()) {
+				component->ResolveHooks();
+				actor->keyedComponents.insert(
+					std::pair((*component)["key"].cast<std::string>(), component));
+				actor->typedComponents[(*component)["type"].cast<std::string>()].push_back(component);
+				HookTable::RegisterComponent(actor, component);
 			}
 		}
+		actor->addedComponents.clear();
+		SpatialIndex::Touch(actor); // A new Rigidbody may have given it a position
 	}
-	SceneDB::compAddedActors.clear();
 }
 
 void SceneDB::RemoveComponents() {
 	SceneDB::nowTrimming = true;
-	for (auto actor : SceneDB::compRemovedActors) {
+	for (auto actor : SceneDB::compRemovedActors.Take()) {
 		for (auto& component : actor->removedComponents) {
 			std::string key = (*component)["key"].cast<std::string>();
 			actor->keyedComponents.erase(key);
 			auto& vec = actor->typedComponents.at((*component)["type"].cast<std::string>());
 			vec.erase(std::find(vec.begin(), vec.end(), component));
+			HookTable::UnregisterComponent(component);
 
-			{
-				auto& vec = actor->startingComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			{
-				auto& vec = actor->updatingComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			{
-				auto& vec = actor->lateUpdatingComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			{
-				auto& vec = actor->collisionEnterComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			{
-				auto& vec = actor->collisionExitComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			{
-				auto& vec = actor->triggerEnterComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			{
-				auto& vec = actor->triggerExitComponents;
-				if (auto it = std::find(vec.begin(), vec.end(), component); it != vec.end()) {
-					vec.erase(it);
-				}
-			}
-
-			if ((*component)["OnDestroy"].isFunction()) {
+			if (component->HasHook(HOOK_DESTROY)) {
+				ProfileScope scope("OnDestroy");
+				ComponentDB::TagScope(scope, actor, *component);
 				try {
-					(*component)["OnDestroy"](*component);
+					component->Invoke(HOOK_DESTROY);
 				}
 				catch (const luabridge::LuaException& e) {
 					ComponentDB::ReportError(actor->GetName(), e);
@@ -587,104 +618,65 @@ void SceneDB::RemoveComponents() {
 			}
 		}
 		actor->removedComponents.clear();
+		SpatialIndex::Touch(actor);
 	}
 	SceneDB::nowTrimming = false;
-	SceneDB::compRemovedActors = SceneDB::willCompRemoveActors;
-	SceneDB::willCompRemoveActors.clear();
+	for (auto actor : SceneDB::willCompRemoveActors.Take()) {
+		SceneDB::compRemovedActors.Insert(actor);
+	}
 }
 
 void SceneDB::AddActors() {
-	for (auto actor : SceneDB::addedActors) {
-		if (!(*actor).startingComponents.empty()) {
-			SceneDB::startingActors.push_back(actor);
-			SceneDB::ActorInsertSort(startingActors);
-		}
-		if (!(*actor).updatingComponents.empty()) {
-			SceneDB::updatingActors.push_back(actor);
-			SceneDB::ActorInsertSort(updatingActors);
-		}
-
-		if (!(*actor).lateUpdatingComponents.empty()) {
-			SceneDB::lateUpdatingActors.push_back(actor);
-			SceneDB::ActorInsertSort(lateUpdatingActors);
-		}
-	}
-	SceneDB::addedActors.clear();
+	// Instantiate already registered these; this is where their entries join the dispatch arrays.
+	HookTable::Flush();
 }
 
 void SceneDB::RemoveActors() {
 	SceneDB::nowRemoving = true;
-	for (auto actor : SceneDB::removedActors) {
-		auto& vec = SceneDB::actors;
-		{
-			auto it = std::find(vec.begin(), vec.end(), actor);
-			if (it != vec.end()) {
-				vec.erase(std::find(vec.begin(), vec.end(), actor));
-			}
+	std::vector<Actor*> doomed;
+	doomed.reserve(SceneDB::removedActors.size());
+	for (auto& handle : SceneDB::removedActors) {
+		if (Actor* actor = handle.Get()) {
+			doomed.push_back(actor);
 		}
+	}
 
-		vec = SceneDB::updatingActors;
-		{
-			auto it = std::find(vec.begin(), vec.end(), actor);
-			if (it != vec.end()) {
-				vec.erase(std::find(vec.begin(), vec.end(), actor));
-			}
-		}
-
-		vec = SceneDB::lateUpdatingActors;
-		{
-			auto it = std::find(vec.begin(), vec.end(), actor);
-			if (it != vec.end()) {
-				vec.erase(std::find(vec.begin(), vec.end(), actor));
-			}
-		}
-
-		vec = SceneDB::retainedActors;
-		{
-			auto it = std::find(vec.begin(), vec.end(), actor);
-			if (it != vec.end()) {
-				vec.erase(std::find(vec.begin(), vec.end(), actor));
-			}
+	// One sweep per name drops every removed actor from namedActors, rather than a search per actor.
+	std::vector<std::vector<Actor*>*> buckets;
+	for (auto actor : doomed) {
+		auto it = SceneDB::namedActors.find(actor->GetName());
+		if (it != SceneDB::namedActors.end()) {
+			buckets.push_back(&it->second);
 		}
+	}
+	std::sort(buckets.begin(), buckets.end());
+	buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+	for (auto vec : buckets) {
+		vec->erase(std::remove_if(vec->begin(), vec->end(), [](Actor* named) { return named->removed; }), vec->end());
+	}
 
-		for (auto& component : actor->destroyingComponents) {
+	for (auto actor : doomed) {
+		for (auto& entry : HookTable::ActorEntries(HOOK_DESTROY, actor)) {
+			ProfileScope scope("OnDestroy");
+			ComponentDB::TagScope(scope, actor, *entry.component);
 			try {
-				(*component)["OnDestroy"](*component);
+				entry.component->Invoke(HOOK_DESTROY);
 			}
 			catch (const luabridge::LuaException& e) {
 				ComponentDB::ReportError(actor->GetName(), e);
 			}
 		}
-
-		actor->destroyingComponents.clear();
-
-		vec = SceneDB::compAddedActors;
-		{
-			auto it = std::find(vec.begin(), vec.end(), actor);
-			if (it != vec.end()) {
-				vec.erase(std::find(vec.begin(), vec.end(), actor));
-			}
-		}
-
-		if (!actor->typedComponents["Rigidbody"].empty()) {
-			for (auto& component : actor->typedComponents["Rigidbody"]) {
-				auto bd = (*component).cast<Rigidbody*>();
-				delete bd;
-			}
+		HookTable::UnregisterActor(actor);
+		ActorStore::Erase(actor);
+		if (!ActorPool::Release(actor)) {
+			DeleteActor(actor);
 		}
-
-		if (!actor->typedComponents["ParticleSystem"].empty()) {
-			for (auto& component : actor->typedComponents["ParticleSystem"]) {
-				auto bd = (*component).cast<ParticleSystem*>();
-				delete bd;
-			}
-		}
-
-		delete actor;
 	}
-	SceneDB::removedActors = SceneDB::willRemoveActors;
+	SceneDB::removedActors.swap(SceneDB::willRemoveActors);
 	SceneDB::willRemoveActors.clear();
 	SceneDB::nowRemoving = false;
+
+	HookTable::Compact();
 }
 
 void SceneDB::EventSubs() {
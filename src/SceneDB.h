@@ -1,11 +1,14 @@
 #pragma once
 #include "Actor.h"
+#include "ActorStore.h"
+#include "CookedScene.h"
 
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 #include "box2d/box2d.h"
+#include "rapidjson/document.h"
 
 class SceneDB {
 public:
@@ -14,20 +17,18 @@ public:
 	static bool nowClearing;
 	static std::string currentScene;
 	static std::string nextScene;
-	static inline std::vector<Actor*> actors;
+	// In dispatch order. Destroyed actors stay until RemoveActors, flagged removed, which Find skips.
 	static inline std::unordered_map<std::string, std::vector<Actor*>> namedActors;
-	static inline std::vector<Actor*> startingActors;
-	static inline std::vector<Actor*> updatingActors;
-	static inline std::vector<Actor*> lateUpdatingActors;
-	static inline std::vector<Actor*> compAddedActors;
-	static inline std::vector<Actor*> compRemovedActors;
-	static inline std::vector<Actor*> addedActors;
-	static inline std::vector<Actor*> removedActors;
-	static inline std::vector<Actor*> willCompRemoveActors;
-	static inline std::vector<Actor*> willRemoveActors;
-	static inline std::vector<Actor*> retainedActors;
+	static inline ActorSet compAddedActors{ QUEUE_COMPONENT_ADD };
+	static inline ActorSet compRemovedActors{ QUEUE_COMPONENT_REMOVE };
+	static inline ActorSet willCompRemoveActors{ QUEUE_COMPONENT_REMOVE_NEXT };
+	static inline std::vector<ActorHandle> removedActors;
+	static inline std::vector<ActorHandle> willRemoveActors;
 	static inline std::vector<Actor*> sceneSaveActors;
 	static inline std::vector<Actor*> systemSaveActors;
+	// Scenes loaded on top of currentScene, with the actors each brought in. All go when currentScene changes.
+	static inline std::unordered_map<std::string, std::vector<ActorHandle>> subScenes;
+	static inline std::vector<std::string> pendingAdditive; // Scene.LoadAdditive, loaded where nextScene would be
 	static b2World world;
 	static inline std::unordered_map<std::string, std::vector<std::pair<luabridge::LuaRef, luabridge::LuaRef>>> event_bus;
 	static inline std::unordered_map<std::string, std::vector<std::pair<luabridge::LuaRef, luabridge::LuaRef>>> pending_subscriptions;
@@ -37,13 +38,24 @@ public:
 
 	static void LuaInit();
 
-	static void ActorInsertSort(std::vector<Actor*>& actors);
+	static std::string ScenePath(const std::string& sceneName); // Exits on a reserved or missing scene
 	static void LoadScene(std::string& sceneName);
+	static void LoadScene(std::string& sceneName, rapidjson::Document& sceneJson); // Already parsed
+	static void LoadScene(std::string& sceneName, const CookedFile& scene);
+	static void LoadAdditive(const std::string& sceneName); // Does nothing if it is already loaded
+	static void LoadAdditive(const std::string& sceneName, rapidjson::Document& sceneJson);
+	static void LoadAdditive(const std::string& sceneName, const CookedFile& scene);
+	static void LoadPendingAdditive();
+	static void UnloadAdditive(const std::string& sceneName); // Also drops a queued or in-flight load
 	static void AddComponents();
 	static void RemoveComponents();
 	static void AddActors();
 	static void RemoveActors();
 	static void EventSubs();
 private:
+	static void BeginSceneLoad(std::string& sceneName); // Clears the old scene, keeping dontDestroyOnLoad actors
+	static void EndSceneLoad();
+	static void LoadActors(rapidjson::Document& sceneJson, std::vector<ActorHandle>* loaded); // Appends their handles to loaded
+	static void LoadActors(const CookedFile& scene, std::vector<ActorHandle>* loaded);
 	SceneDB() {}
 };
\ No newline at end of file
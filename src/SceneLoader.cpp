@@ -0,0 +1,404 @@
+#include "AudioDB.h"
+#include "ComponentDB.h"
+#include "CookedScene.h"
+#include "EngineUtils.h"
+#include "ImageDB.h"
+#include "SceneDB.h"
+#include "SceneLoader.h"
+#include "TemplateDB.h"
+#include "TextureAtlas.h"
+
+#include "AudioHelper.h"
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "rapidjson/document.h"
+#include "SDL2_Img/SDL_image.h"
+#include "SDL2_Mix/SDL_mixer.h"
+
+bool IsNativeType(const std::string& type) {
+	return type == "Rigidbody" || type == "ParticleSystem";
+}
+
+void SceneLoader::Parse(AsyncSceneLoad* load, std::string scenePath, std::unordered_set<std::string> knownAssets, bool packAtlas) {
+	ParsedScene& parsed = load->parsed;
+	// A scene swap brings in the scene's atlas pages, which hold their own copies of their images.
+	if (!load->additive) {
+		for (auto& image : TextureAtlas::ImagesFor(parsed.name)) {
+			knownAssets.insert(image);
+		}
+	}
+
+	std::unordered_set<std::string> types;
+	std::unordered_set<std::string> strings;
+	std::vector<std::string> assetNames; // In the order the scene mentions them
+	auto note_type = [&](const std::string& type) {
+		if (!IsNativeType(type) && types.insert(type).second) {
+			parsed.componentTypes.push_back(type);
+		}
+	};
+	auto note_string = [&](const std::string& value) {
+		if (knownAssets.find(value) == knownAssets.end() && strings.insert(value).second) {
+			assetNames.push_back(value);
+		}
+	};
+	auto collect = [&](rapidjson::Value& components) {
+		if (!components.IsObject()) {
+			return;
+		}
+		for (auto itr = components.MemberBegin(); itr != components.MemberEnd(); ++itr) {
+			if (!itr->value.IsObject()) {
+				continue;
+			}
+			for (auto field = itr->value.MemberBegin(); field != itr->value.MemberEnd(); ++field) {
+				if (!field->value.IsString()) {
+					continue;
+				}
+				if (std::string(field->name.GetString()) == "type") {
+					note_type(field->value.GetString());
+				}
+				else {
+					note_string(field->value.GetString());
+				}
+			}
+		}
+	};
+	auto collect_cooked = [&](const CookedFile& file, const CookedActor& actor) {
+		for (uint32_t c = 0; c < actor.componentCount; c++) {
+			const CookedComponent& component = file.ComponentAt(actor.firstComponent + c);
+			if (component.type != COOKED_NONE) {
+				note_type(file.String(component.type));
+			}
+			for (uint32_t o = 0; o < component.overrideCount; o++) {
+				const CookedOverride& value = file.OverrideAt(component.firstOverride + o);
+				if (value.kind == COOKED_STRING) {
+					note_string(file.String(value.value.s));
+				}
+			}
+		}
+	};
+
+	std::unordered_set<std::string> templateNames;
+	auto add_template = [&](const std::string& templateName) {
+		if (!templateNames.insert(templateName).second) {
+			return;
+		}
+		// A cooked template is mapped in place when it is needed, so there is nothing to parse ahead.
+		CookedFile cooked;
+		if (cooked.Open(CookedScene::TemplatePath(templateName), COOKED_TEMPLATE) && cooked.ActorCount() == 1) {
+			collect_cooked(cooked, cooked.ActorAt(0));
+			parsed.templates.emplace_back(templateName, nullptr);
+			return;
+		}
+		// A missing template is left for LoadScene, which reports it exactly as a synchronous load would.
+		std::string templatePath = "resources/actor_templates/" + templateName + ".template";
+		if (std::filesystem::exists(templatePath)) {
+			auto templateJson = std::make_unique<rapidjson::Document>();
+			if (!ParseJsonFile(templatePath, *templateJson)) {
+				load->errorPath = templatePath;
+				return;
+			}
+			if (templateJson->HasMember("components")) {
+				collect((*templateJson)["components"]);
+			}
+			parsed.templates.emplace_back(templateName, std::move(templateJson));
+		}
+	};
+
+	if (parsed.cooked.Open(CookedScene::ScenePath(parsed.name), COOKED_SCENE)) {
+		for (uint32_t i = 0; i < parsed.cooked.ActorCount(); i++) {
+			const CookedActor& actor = parsed.cooked.ActorAt(i);
+			if (actor.templateName != COOKED_NONE) {
+				add_template(parsed.cooked.String(actor.templateName));
+			}
+			collect_cooked(parsed.cooked, actor);
+		}
+	}
+	else if (!ParseJsonFile(scenePath, parsed.scene)) {
+		load->errorPath = scenePath;
+	}
+	else {
+		if (parsed.scene.HasMember("actors") && parsed.scene["actors"].IsArray()) {
+			for (auto& actor : parsed.scene["actors"].GetArray()) {
+				if (load->errorPath.empty() && actor.HasMember("template") && actor["template"].IsString()) {
+					add_template(actor["template"].GetString());
+				}
+				if (actor.HasMember("components")) {
+					collect(actor["components"]);
+				}
+			}
+		}
+	}
+
+	// The load ends in an error on the main thread, so there is nothing worth decoding.
+	if (!load->errorPath.empty()) {
+		load->steps = 1;
+		load->ready.store(true, std::memory_order_release);
+		return;
+	}
+
+	// Components keep images and clips as bare names, so any string naming a file is worth decoding now.
+	for (auto& name : assetNames) {
+		std::string imagePath = "resources/images/" + name + ".png";
+		if (std::filesystem::exists(imagePath)) {
+			if (SDL_Surface* surface = IMG_Load(imagePath.c_str())) {
+				parsed.images.emplace_back(name, surface);
+			}
+		}
+
+		std::string clipPath = "resources/audio/" + name + ".wav";
+		if (!std::filesystem::exists(clipPath)) {
+			clipPath = "resources/audio/" + name + ".ogg";
+		}
+		if (std::filesystem::exists(clipPath)) {
+			if (Mix_Chunk* chunk = AudioHelper::Mix_LoadWAV(clipPath.c_str())) {
+				parsed.sounds.emplace_back(name, chunk);
+			}
+		}
+	}
+
+	if (packAtlas) {
+		parsed.atlas = TextureAtlas::Pack(parsed.name);
+	}
+
+	load->steps = parsed.componentTypes.size() + parsed.templates.size() + parsed.images.size() + parsed.sounds.size() + 1;
+	load->ready.store(true, std::memory_order_release);
+}
+
+void SceneLoader::RunStep(AsyncSceneLoad& load, size_t step) {
+	ParsedScene& parsed = load.parsed;
+	if (step < parsed.componentTypes.size()) {
+		ComponentDB::LoadComponentType(parsed.componentTypes[step]);
+		return;
+	}
+	step -= parsed.componentTypes.size();
+	if (step < parsed.templates.size()) {
+		if (parsed.templates[step].second != nullptr) {
+			TemplateDB::Preload(parsed.templates[step].first, *parsed.templates[step].second);
+		}
+		else {
+			TemplateDB::Preload(parsed.templates[step].first);
+		}
+		return;
+	}
+	step -= parsed.templates.size();
+	if (step < parsed.images.size()) {
+		ImageDB::AdoptSurface(parsed.images[step].first, parsed.images[step].second);
+		parsed.images[step].second = nullptr;
+		return;
+	}
+	step -= parsed.images.size();
+	AudioDB::Adopt(parsed.sounds[step].first, parsed.sounds[step].second);
+	parsed.sounds[step].second = nullptr;
+}
+
+void SceneLoader::Discard(AsyncSceneLoad& load) {
+	if (load.worker.joinable()) {
+		load.worker.join();
+	}
+	for (auto& image : load.parsed.images) {
+		if (image.second != nullptr) {
+			SDL_FreeSurface(image.second);
+		}
+	}
+	// Decoded clips are cheap to keep and may well be played later, so they go in the cache either way.
+	for (auto& sound : load.parsed.sounds) {
+		if (sound.second != nullptr) {
+			AudioDB::Adopt(sound.first, sound.second);
+		}
+	}
+}
+
+std::unique_ptr<AsyncSceneLoad> SceneLoader::Start(const std::string& sceneName, const std::string& scenePath, bool additive) {
+	std::unordered_set<std::string> knownAssets;
+	for (auto& image : ImageDB::imageMap) {
+		knownAssets.insert(image.first);
+	}
+	// An additive scene draws from the pages already resident.
+	if (additive) {
+		for (auto& image : TextureAtlas::ResidentNames()) {
+			knownAssets.insert(image);
+		}
+	}
+	for (auto& sound : AudioDB::sound_chunks) {
+		knownAssets.insert(sound.first);
+	}
+
+	auto load = std::make_unique<AsyncSceneLoad>();
+	load->parsed.name = sceneName;
+	load->additive = additive;
+	bool pack_atlas = !additive && TextureAtlas::NeedsPack(sceneName);
+	load->worker = std::thread(&SceneLoader::Parse, load.get(), scenePath, std::move(knownAssets), pack_atlas);
+	return load;
+}
+
+bool SceneLoader::LoadAsync(const std::string& sceneName) {
+	std::string scenePath = SceneDB::ScenePath(sceneName);
+	if (SceneLoader::current != nullptr && SceneLoader::current->parsed.name == sceneName) {
+		return false;
+	}
+	SceneLoader::Cancel();
+
+	SceneLoader::current = SceneLoader::Start(sceneName, scenePath, false);
+	return true;
+}
+
+bool SceneLoader::LoadAdditiveAsync(const std::string& sceneName) {
+	std::string scenePath = SceneDB::ScenePath(sceneName);
+	if (SceneDB::subScenes.find(sceneName) != SceneDB::subScenes.end() || SceneLoader::IsLoadingAdditive(sceneName)) {
+		return false;
+	}
+
+	SceneLoader::additiveLoads.push_back(SceneLoader::Start(sceneName, scenePath, true));
+	return true;
+}
+
+bool SceneLoader::IsLoadingAdditive(const std::string& sceneName) {
+	for (auto& load : SceneLoader::additiveLoads) {
+		if (load->parsed.name == sceneName) {
+			return true;
+		}
+	}
+	return false;
+}
+
+float SceneLoader::GetProgress() {
+	if (SceneLoader::current == nullptr) {
+		return 1.0f;
+	}
+	if (!SceneLoader::current->ready.load(std::memory_order_acquire)) {
+		return 0.0f;
+	}
+	return static_cast<float>(SceneLoader::current->step) / static_cast<float>(SceneLoader::current->steps);
+}
+
+bool SceneLoader::Advance(AsyncSceneLoad& load, std::chrono::steady_clock::time_point deadline) {
+	if (!load.ready.load(std::memory_order_acquire)) {
+		return false;
+	}
+	if (load.worker.joinable()) {
+		load.worker.join();
+	}
+	if (!load.errorPath.empty()) {
+		ExitOnJsonError(load.errorPath);
+	}
+
+	// At least one step a frame, so a budget smaller than any step still gets there.
+	do {
+		if (load.step + 1 == load.steps) {
+			return true;
+		}
+		SceneLoader::RunStep(load, load.step);
+		load.step++;
+	} while (std::chrono::steady_clock::now() < deadline);
+	return false;
+}
+
+void SceneLoader::Finish(AsyncSceneLoad& load) {
+	ParsedScene& parsed = load.parsed;
+	if (load.additive) {
+		if (parsed.cooked.IsOpen()) {
+			SceneDB::LoadAdditive(parsed.name, parsed.cooked);
+		}
+		else {
+			SceneDB::LoadAdditive(parsed.name, parsed.scene);
+		}
+	}
+	else {
+		// Only uploading is left, done as the old scene is torn down.
+		if (parsed.atlas != nullptr) {
+			TextureAtlas::Adopt(std::move(parsed.atlas));
+		}
+		if (parsed.cooked.IsOpen()) {
+			SceneDB::LoadScene(parsed.name, parsed.cooked);
+		}
+		else {
+			SceneDB::LoadScene(parsed.name, parsed.scene);
+		}
+	}
+}
+
+void SceneLoader::Update() {
+	for (auto it = SceneLoader::abandoned.begin(); it != SceneLoader::abandoned.end();) {
+		if ((*it)->ready.load(std::memory_order_acquire)) {
+			SceneLoader::Discard(**it);
+			it = SceneLoader::abandoned.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	// Every load in flight shares one budget. The scene itself is always the last step, and is taken
+	// whole at the point a synchronous load would run; each load is moved out first, since that step
+	// runs scripts that may start another.
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+		+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(SceneLoader::sliceBudgetMs));
+	if (SceneLoader::current != nullptr && SceneLoader::Advance(*SceneLoader::current, deadline)) {
+		std::unique_ptr<AsyncSceneLoad> finished = std::move(SceneLoader::current);
+		for (auto& load : SceneLoader::additiveLoads) {
+			SceneLoader::abandoned.push_back(std::move(load));
+		}
+		SceneLoader::additiveLoads.clear();
+		SceneLoader::Finish(*finished);
+		return;
+	}
+
+	for (size_t i = 0; i < SceneLoader::additiveLoads.size() && std::chrono::steady_clock::now() < deadline;) {
+		if (SceneLoader::Advance(*SceneLoader::additiveLoads[i], deadline)) {
+			std::unique_ptr<AsyncSceneLoad> finished = std::move(SceneLoader::additiveLoads[i]);
+			SceneLoader::additiveLoads.erase(SceneLoader::additiveLoads.begin() + i);
+			SceneLoader::Finish(*finished);
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+void SceneLoader::Cancel() {
+	if (SceneLoader::current != nullptr) {
+		SceneLoader::abandoned.push_back(std::move(SceneLoader::current));
+	}
+	for (auto& load : SceneLoader::additiveLoads) {
+		SceneLoader::abandoned.push_back(std::move(load));
+	}
+	SceneLoader::additiveLoads.clear();
+}
+
+void SceneLoader::CancelAdditive(const std::string& sceneName) {
+	for (auto it = SceneLoader::additiveLoads.begin(); it != SceneLoader::additiveLoads.end(); ++it) {
+		if ((*it)->parsed.name == sceneName) {
+			SceneLoader::abandoned.push_back(std::move(*it));
+			SceneLoader::additiveLoads.erase(it);
+			return;
+		}
+	}
+}
+
+void SceneLoader::Shutdown() {
+	SceneLoader::Cancel();
+	for (auto& load : SceneLoader::abandoned) {
+		SceneLoader::Discard(*load);
+	}
+	SceneLoader::abandoned.clear();
+}
+
+void SceneLoader::LuaInit() {
+	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
+		.beginNamespace("Scene")
+		.addFunction("LoadAsync", &SceneLoader::LoadAsync)
+		.addFunction("LoadAdditiveAsync", &SceneLoader::LoadAdditiveAsync)
+		.addFunction("GetLoadProgress", &SceneLoader::GetProgress)
+		.addFunction("IsLoading", &SceneLoader::IsLoading)
+		.endNamespace();
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include "CookedScene.h"
+#include "TextureAtlas.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "SDL2_Img/SDL_image.h"
+#include "SDL2_Mix/SDL_mixer.h"
+
+/* Everything a scene load needs from disk, read by a background thread: the parsed scene, the templates
+   it names that were not loaded yet, and the images and sounds its components refer to, decoded. */
+struct ParsedScene {
+	std::string name;
+	CookedFile cooked; // Open when the scene has a fresh cooked file, and then scene is left empty
+	rapidjson::Document scene;
+	std::vector<std::pair<std::string, std::unique_ptr<rapidjson::Document>>> templates; // Null when cooked
+	std::vector<std::string> componentTypes;
+	std::vector<std::pair<std::string, SDL_Surface*>> images;
+	std::vector<std::pair<std::string, Mix_Chunk*>> sounds;
+	std::unique_ptr<PackedAtlas> atlas; // The scene's atlas pages, when they differ from the resident ones
+};
+
+/* One Scene.LoadAsync in flight. Once the thread is done, the main thread turns its results into
+   templates, compiled component types, textures and sound chunks a few at a time, then swaps scenes. */
+struct AsyncSceneLoad {
+	ParsedScene parsed;
+	std::thread worker;
+	std::atomic<bool> ready{ false }; // The thread has finished with parsed
+	std::string errorPath; // A file the thread could not parse; the main thread reports it and exits
+	size_t step = 0; // Main-thread steps finished
+	size_t steps = 0;
+	bool additive = false; // Ends in SceneDB::LoadAdditive rather than a scene swap; set before the thread starts
+};
+
+class SceneLoader {
+public:
+	static inline double sliceBudgetMs = 4.0; // Main-thread time per frame, game.config "scene_load_budget_ms"
+
+	static bool LoadAsync(const std::string& sceneName);
+	static bool LoadAdditiveAsync(const std::string& sceneName); // False if it is loaded or on its way
+	static bool IsLoading() {
+		return SceneLoader::current != nullptr;
+	}
+	static bool IsLoadingAdditive(const std::string& sceneName);
+	static bool IsBusy() {
+		return SceneLoader::current != nullptr || !SceneLoader::additiveLoads.empty() || !SceneLoader::abandoned.empty();
+	}
+	static float GetProgress();
+	static void Update(); // Once per frame, where a requested scene would be loaded
+	static void Cancel(); // A synchronous load replaces the one in flight, and the old scene's additive loads with it
+	static void CancelAdditive(const std::string& sceneName);
+	static void Shutdown();
+	static void LuaInit();
+private:
+	static inline std::unique_ptr<AsyncSceneLoad> current;
+	static inline std::vector<std::unique_ptr<AsyncSceneLoad>> additiveLoads; // In the order they were asked for
+	static inline std::vector<std::unique_ptr<AsyncSceneLoad>> abandoned; // Freed once their threads finish
+
+	static std::unique_ptr<AsyncSceneLoad> Start(const std::string& sceneName, const std::string& scenePath, bool additive);
+	static void Parse(AsyncSceneLoad* load, std::string scenePath, std::unordered_set<std::string> knownAssets, bool packAtlas);
+	static void RunStep(AsyncSceneLoad& load, size_t step);
+	static bool Advance(AsyncSceneLoad& load, std::chrono::steady_clock::time_point deadline); // True once only the scene itself is left
+	static void Finish(AsyncSceneLoad& load);
+	static void Discard(AsyncSceneLoad& load);
+	SceneLoader() {}
+};
\ No newline at end of file
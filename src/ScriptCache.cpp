@@ -0,0 +1,183 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "ScriptCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "Lua/lua.hpp"
+
+const uint32_t SCRIPT_CACHE_MAGIC = 0x3143424C; // "LBC1"
+
+static int DumpWriter(lua_State*, const void* chunk, size_t size, void* data) {
+	static_cast<std::string*>(data)->append(static_cast<const char*>(chunk), size);
+	return 0;
+}
+
+static bool StatSource(const std::string& path, ScriptCacheHeader& header) {
+	std::error_code error;
+	auto mtime = std::filesystem::last_write_time(path, error);
+	if (error) {
+		return false;
+	}
+	auto size = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	header.magic = SCRIPT_CACHE_MAGIC;
+	header.luaVersion = LUA_VERSION_NUM;
+	header.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+	header.size = static_cast<uint64_t>(size);
+	return true;
+}
+
+uint64_t ScriptCache::Hash(const std::string& data) {
+	// FNV-1a; only has to notice edits, not resist anyone.
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : data) {
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::string ScriptCache::CachePath(const std::string& path) {
+	std::string flattened = path;
+	std::replace(flattened.begin(), flattened.end(), '/', '_');
+	std::replace(flattened.begin(), flattened.end(), '\\', '_');
+	return ScriptCache::cacheDirectory + "/" + flattened + "c";
+}
+
+bool ScriptCache::ReadSource(const std::string& path, std::string& source) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) {
+		return false;
+	}
+	source.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+bool ScriptCache::ReadCache(const std::string& cache_path, ScriptCacheHeader& header, std::string& bytecode) {
+	std::ifstream in(cache_path, std::ios::binary);
+	if (!in.is_open()) {
+		return false;
+	}
+	in.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!in || header.magic != SCRIPT_CACHE_MAGIC || header.luaVersion != LUA_VERSION_NUM) {
+		return false;
+	}
+	bytecode.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return !bytecode.empty();
+}
+
+void ScriptCache::WriteCache(const std::string& cache_path, const ScriptCacheHeader& header, const std::string& bytecode) {
+	std::error_code error;
+	std::filesystem::create_directories(ScriptCache::cacheDirectory, error);
+
+	// Write beside the target and rename over it, so a reader never sees half a file.
+	std::string temp_path = cache_path + ".tmp";
+	{
+		std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) {
+			return;
+		}
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(bytecode.data(), bytecode.size());
+		if (!out) {
+			return;
+		}
+	}
+	std::filesystem::rename(temp_path, cache_path, error);
+	if (error) {
+		std::filesystem::remove(temp_path, error);
+	}
+}
+
+int ScriptCache::Compile(lua_State* L, const std::string& path, const std::string& source, std::string& bytecode) {
+	std::string chunk_name = "@" + path; // Same name luaL_loadfile uses, so error messages do not change
+	int status = luaL_loadbufferx(L, source.data(), source.size(), chunk_name.c_str(), "t");
+	if (status != LUA_OK) {
+		return status;
+	}
+	// Keep debug info: runtime errors still need file and line.
+	bytecode.clear();
+	lua_dump(L, &DumpWriter, &bytecode, 0);
+	return LUA_OK;
+}
+
+int ScriptCache::Load(lua_State* L, const std::string& path) {
+	PROFILE_SCOPE("LoadScript");
+	ScriptCacheHeader current;
+	if (!ScriptCache::enabled || !StatSource(path, current)) {
+		return luaL_loadfile(L, path.c_str());
+	}
+
+	std::string cache_path = ScriptCache::CachePath(path);
+	ScriptCacheHeader cached;
+	std::string bytecode;
+	std::string source;
+	bool have_source = false;
+
+	if (ScriptCache::ReadCache(cache_path, cached, bytecode)) {
+		bool valid = cached.mtime == current.mtime && cached.size == current.size;
+		if (!valid && ScriptCache::ReadSource(path, source)) {
+			have_source = true;
+			current.hash = ScriptCache::Hash(source);
+			valid = cached.hash == current.hash;
+			if (valid) {
+				// Content is unchanged; refresh the stamp so the next run takes the fast path.
+				ScriptCache::WriteCache(cache_path, current, bytecode);
+			}
+		}
+
+		if (valid) {
+			std::string chunk_name = "@" + path;
+			if (luaL_loadbufferx(L, bytecode.data(), bytecode.size(), chunk_name.c_str(), "b") == LUA_OK) {
+				return LUA_OK;
+			}
+			lua_pop(L, 1); // Unreadable cache (different build of Lua, truncated file): recompile below
+		}
+	}
+
+	if (!have_source) {
+		if (!ScriptCache::ReadSource(path, source)) {
+			return luaL_loadfile(L, path.c_str());
+		}
+		current.hash = ScriptCache::Hash(source);
+	}
+
+	int status = ScriptCache::Compile(L, path, source, bytecode);
+	if (status == LUA_OK) {
+		ScriptCache::WriteCache(cache_path, current, bytecode);
+	}
+	return status;
+}
+
+void ScriptCache::PrecompileAll(const std::string& directory) {
+	PROFILE_SCOPE("PrecompileScripts");
+	if (!ScriptCache::enabled || !std::filesystem::exists(directory)) {
+		return;
+	}
+
+	std::vector<std::string> paths;
+	for (auto& entry : std::filesystem::directory_iterator(directory)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".lua") {
+			paths.push_back(directory + "/" + entry.path().filename().string());
+		}
+	}
+
+	// A lua_State is single-threaded, so each job compiles in a throwaway state of its own.
+	// Errors are left for the real load to report, where the engine already handles them.
+	JobSystem::ParallelFor(0, static_cast<int>(paths.size()), 1, [&paths](int begin, int end) {
+		lua_State* L = luaL_newstate();
+		for (int i = begin; i < end; i++) {
+			ScriptCache::Load(L, paths[i]);
+			lua_settop(L, 0);
+		}
+		lua_close(L);
+	});
+}
\ No newline at end of file
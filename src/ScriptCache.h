@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Lua/lua.hpp"
+
+/* Prefix of every cache file. A source file's cached chunk is valid while its mtime and size match,
+   or, failing that, while the source still hashes to the same value (e.g. after a checkout touched it). */
+struct ScriptCacheHeader {
+	uint32_t magic = 0;
+	uint32_t luaVersion = 0;
+	int64_t mtime = 0;
+	uint64_t size = 0;
+	uint64_t hash = 0;
+};
+
+class ScriptCache {
+public:
+	static inline bool enabled = true;
+	static inline bool precompile = false;
+	static inline std::string cacheDirectory = "cache/bytecode";
+
+	static int Load(lua_State* L, const std::string& path);
+	static void PrecompileAll(const std::string& directory);
+private:
+	static std::string CachePath(const std::string& path);
+	static bool ReadSource(const std::string& path, std::string& source);
+	static bool ReadCache(const std::string& cache_path, ScriptCacheHeader& header, std::string& bytecode);
+	static void WriteCache(const std::string& cache_path, const ScriptCacheHeader& header, const std::string& bytecode);
+	static int Compile(lua_State* L, const std::string& path, const std::string& source, std::string& bytecode);
+	static uint64_t Hash(const std::string& data);
+	ScriptCache() {}
+};
\ No newline at end of file
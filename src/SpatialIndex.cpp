@@ -0,0 +1,321 @@
+#include "Actor.h"
+#include "ActorStore.h"
+#include "ComponentDB.h"
+#include "Rigidbody.h"
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "box2d/box2d.h"
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+struct Hit {
+	float distance2;
+	Actor* actor;
+};
+
+bool HitBefore(const Hit& a, const Hit& b) {
+	if (a.distance2 != b.distance2) {
+		return a.distance2 < b.distance2;
+	}
+	return a.actor->hookOrder < b.actor->hookOrder;
+}
+
+luabridge::LuaRef HitsToLua(std::vector<Hit>& hits) {
+	lua_State* L = ComponentDB::GetLuaState();
+	lua_createtable(L, static_cast<int>(hits.size()), 0);
+	luabridge::LuaRef actorTable = luabridge::LuaRef::fromStack(L, -1);
+	lua_pop(L, 1);
+	int iter = 1;
+	for (auto& hit : hits) {
+		actorTable[iter] = hit.actor->handle;
+		iter++;
+	}
+	return actorTable;
+}
+
+bool SpatialIndex::PositionOf(Actor* actor, b2Vec2& position) {
+	auto it = actor->typedComponents.find("Rigidbody");
+	if (it != actor->typedComponents.end() && !it->second.empty()) {
+		position = (*it->second.front()).cast<Rigidbody*>()->GetPosition();
+		return true;
+	}
+	if (actor->hasPosition) {
+		position = b2Vec2(actor->positionX, actor->positionY);
+		return true;
+	}
+	return false;
+}
+
+bool SpatialIndex::Filter::Matches(Actor* actor) const {
+	if (actor->removed) {
+		return false;
+	}
+	if (!this->name.empty() && actor->GetName() != this->name) {
+		return false;
+	}
+	if (!this->type.empty()) {
+		auto it = actor->typedComponents.find(this->type);
+		if (it == actor->typedComponents.end() || it->second.empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+SpatialIndex::Filter SpatialIndex::ParseFilter(const luabridge::LuaRef& filter) {
+	Filter parsed;
+	if (filter.isString()) {
+		parsed.name = filter.cast<std::string>();
+	}
+	else if (filter.isTable()) {
+		if (filter["name"].isString()) {
+			parsed.name = filter["name"].cast<std::string>();
+		}
+		if (filter["type"].isString()) {
+			parsed.type = filter["type"].cast<std::string>();
+		}
+	}
+	return parsed;
+}
+
+void SpatialIndex::Touch(Actor* actor) {
+	// While dirty the next query rebuilds everything anyway.
+	if (actor == nullptr || actor->spatialPending || SpatialIndex::dirty || ActorStore::Resolve(actor->handle) != actor) {
+		return;
+	}
+	actor->spatialPending = true;
+	SpatialIndex::pending.push_back(actor->handle);
+}
+
+void SpatialIndex::Remove(Actor* actor) {
+	// Its handle goes stale as it leaves the store, so the pending list skips it.
+	actor->spatialPending = false;
+	SpatialIndex::Unplace(actor);
+}
+
+void SpatialIndex::Place(Actor* actor, float x, float y) {
+	Entry entry = { x, y, CellOf(x), CellOf(y), actor };
+	uint32_t bucket = Bucket(entry.cellX, entry.cellY);
+	actor->spatialBucket = bucket;
+	actor->spatialSlot = static_cast<uint32_t>(SpatialIndex::buckets[bucket].size());
+	SpatialIndex::buckets[bucket].push_back(entry);
+	SpatialIndex::entryCount++;
+	SpatialIndex::minCellX = std::min(SpatialIndex::minCellX, entry.cellX);
+	SpatialIndex::minCellY = std::min(SpatialIndex::minCellY, entry.cellY);
+	SpatialIndex::maxCellX = std::max(SpatialIndex::maxCellX, entry.cellX);
+	SpatialIndex::maxCellY = std::max(SpatialIndex::maxCellY, entry.cellY);
+}
+
+void SpatialIndex::Unplace(Actor* actor) {
+	if (actor->spatialBucket == NO_BUCKET) {
+		return;
+	}
+	auto& bucket = SpatialIndex::buckets[actor->spatialBucket];
+	bucket[actor->spatialSlot] = bucket.back();
+	bucket[actor->spatialSlot].actor->spatialSlot = actor->spatialSlot;
+	bucket.pop_back();
+	actor->spatialBucket = NO_BUCKET;
+	SpatialIndex::entryCount--;
+}
+
+void SpatialIndex::Refresh() {
+	if (!SpatialIndex::dirty) {
+		b2Vec2 position;
+		for (auto& handle : SpatialIndex::pending) {
+			Actor* actor = handle.Get();
+			if (actor == nullptr) {
+				continue;
+			}
+			actor->spatialPending = false;
+			bool located = SpatialIndex::PositionOf(actor, position);
+			if (located && actor->spatialBucket != NO_BUCKET) {
+				// Still in the same cell: only the entry's position changes.
+				Entry& entry = SpatialIndex::buckets[actor->spatialBucket][actor->spatialSlot];
+				if (entry.cellX == CellOf(position.x) && entry.cellY == CellOf(position.y)) {
+					entry.x = position.x;
+					entry.y = position.y;
+					continue;
+				}
+			}
+			SpatialIndex::Unplace(actor);
+			if (located) {
+				SpatialIndex::Place(actor, position.x, position.y);
+			}
+		}
+		SpatialIndex::pending.clear();
+
+		// Past one entry per bucket the chains grow long; the rebuild doubles the buckets.
+		if (SpatialIndex::entryCount > SpatialIndex::buckets.size()) {
+			SpatialIndex::dirty = true;
+		}
+	}
+	if (SpatialIndex::dirty) {
+		SpatialIndex::Rebuild();
+	}
+}
+
+void SpatialIndex::Rebuild() {
+	SpatialIndex::dirty = false;
+	for (auto& handle : SpatialIndex::pending) {
+		if (Actor* actor = handle.Get()) {
+			actor->spatialPending = false;
+		}
+	}
+	SpatialIndex::pending.clear();
+
+	// Twice as many buckets as actors keeps collisions rare.
+	const std::vector<Actor*>& live = ActorStore::Live();
+	size_t bucket_count = 16;
+	while (bucket_count < live.size() * 2) {
+		bucket_count <<= 1;
+	}
+	SpatialIndex::buckets.resize(bucket_count);
+	for (auto& bucket : SpatialIndex::buckets) {
+		bucket.clear();
+	}
+	SpatialIndex::entryCount = 0;
+	SpatialIndex::minCellX = INT32_MAX;
+	SpatialIndex::minCellY = INT32_MAX;
+	SpatialIndex::maxCellX = INT32_MIN;
+	SpatialIndex::maxCellY = INT32_MIN;
+
+	b2Vec2 position;
+	for (auto actor : live) {
+		actor->spatialBucket = NO_BUCKET;
+		if (SpatialIndex::PositionOf(actor, position)) {
+			SpatialIndex::Place(actor, position.x, position.y);
+		}
+	}
+}
+
+template <class Visit>
+void SpatialIndex::VisitAll(const Visit& visit) {
+	for (auto& bucket : SpatialIndex::buckets) {
+		for (auto& entry : bucket) {
+			visit(entry);
+		}
+	}
+}
+
+template <class Visit>
+void SpatialIndex::VisitCells(int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y, const Visit& visit) {
+	min_x = std::max(min_x, SpatialIndex::minCellX);
+	min_y = std::max(min_y, SpatialIndex::minCellY);
+	max_x = std::min(max_x, SpatialIndex::maxCellX);
+	max_y = std::min(max_y, SpatialIndex::maxCellY);
+	if (min_x > max_x || min_y > max_y) {
+		return;
+	}
+
+	// A range wider than the population is cheaper to answer with one pass over everything.
+	int64_t cells = (static_cast<int64_t>(max_x) - min_x + 1) * (static_cast<int64_t>(max_y) - min_y + 1);
+	if (cells > static_cast<int64_t>(SpatialIndex::entryCount)) {
+		SpatialIndex::VisitAll([&](const Entry& entry) {
+			if (entry.cellX >= min_x && entry.cellX <= max_x && entry.cellY >= min_y && entry.cellY <= max_y) {
+				visit(entry);
+			}
+		});
+		return;
+	}
+
+	for (int32_t cell_y = min_y; cell_y <= max_y; cell_y++) {
+		for (int32_t cell_x = min_x; cell_x <= max_x; cell_x++) {
+			for (const Entry& entry : SpatialIndex::buckets[Bucket(cell_x, cell_y)]) {
+				if (entry.cellX == cell_x && entry.cellY == cell_y) {
+					visit(entry);
+				}
+			}
+		}
+	}
+}
+
+luabridge::LuaRef SpatialIndex::FindInRadius(float x, float y, float radius, luabridge::LuaRef filter) {
+	SpatialIndex::Refresh();
+	Filter parsed = SpatialIndex::ParseFilter(filter);
+	float radius2 = radius * radius;
+	std::vector<Hit> hits;
+	if (radius >= 0.0f) {
+		VisitCells(CellOf(x - radius), CellOf(y - radius), CellOf(x + radius), CellOf(y + radius), [&](const Entry& entry) {
+			float dx = entry.x - x;
+			float dy = entry.y - y;
+			float distance2 = dx * dx + dy * dy;
+			if (distance2 <= radius2 && parsed.Matches(entry.actor)) {
+				hits.push_back({ distance2, entry.actor });
+			}
+		});
+	}
+	std::sort(hits.begin(), hits.end(), &HitBefore);
+	return HitsToLua(hits);
+}
+
+luabridge::LuaRef SpatialIndex::FindInRect(float min_x, float min_y, float max_x, float max_y, luabridge::LuaRef filter) {
+	SpatialIndex::Refresh();
+	Filter parsed = SpatialIndex::ParseFilter(filter);
+	std::vector<Hit> hits;
+	VisitCells(CellOf(min_x), CellOf(min_y), CellOf(max_x), CellOf(max_y), [&](const Entry& entry) {
+		if (entry.x >= min_x && entry.x <= max_x && entry.y >= min_y && entry.y <= max_y && parsed.Matches(entry.actor)) {
+			hits.push_back({ 0.0f, entry.actor });
+		}
+	});
+	std::sort(hits.begin(), hits.end(), &HitBefore);
+	return HitsToLua(hits);
+}
+
+luabridge::LuaRef SpatialIndex::FindNearest(float x, float y, luabridge::LuaRef filter) {
+	SpatialIndex::Refresh();
+	Filter parsed = SpatialIndex::ParseFilter(filter);
+	Hit best = { 0.0f, nullptr };
+	auto consider = [&](const Entry& entry) {
+		float dx = entry.x - x;
+		float dy = entry.y - y;
+		Hit hit = { dx * dx + dy * dy, entry.actor };
+		if ((best.actor == nullptr || HitBefore(hit, best)) && parsed.Matches(entry.actor)) {
+			best = hit;
+		}
+	};
+
+	// Walk square rings of cells outward. Anything beyond ring k is at least k cells away,
+	// so once the best match is that close the search is over.
+	int32_t cell_x = CellOf(x);
+	int32_t cell_y = CellOf(y);
+	int64_t first_ring = std::max({ int64_t(0), int64_t(SpatialIndex::minCellX) - cell_x, int64_t(cell_x) - SpatialIndex::maxCellX,
+		int64_t(SpatialIndex::minCellY) - cell_y, int64_t(cell_y) - SpatialIndex::maxCellY });
+	int64_t last_ring = std::max({ int64_t(cell_x) - SpatialIndex::minCellX, int64_t(SpatialIndex::maxCellX) - cell_x,
+		int64_t(cell_y) - SpatialIndex::minCellY, int64_t(SpatialIndex::maxCellY) - cell_y });
+	for (int64_t ring = first_ring; ring <= last_ring; ring++) {
+		if (ring * 8 > static_cast<int64_t>(SpatialIndex::entryCount)) {
+			// The rings now cost more than a pass over everything.
+			SpatialIndex::VisitAll(consider);
+			break;
+		}
+
+		int32_t k = static_cast<int32_t>(ring);
+		VisitCells(cell_x - k, cell_y - k, cell_x + k, cell_y - k, consider);
+		if (k > 0) {
+			VisitCells(cell_x - k, cell_y + k, cell_x + k, cell_y + k, consider);
+			VisitCells(cell_x - k, cell_y - k + 1, cell_x - k, cell_y + k - 1, consider);
+			VisitCells(cell_x + k, cell_y - k + 1, cell_x + k, cell_y + k - 1, consider);
+		}
+
+		float reach = static_cast<float>(ring) * SpatialIndex::cellSize;
+		if (best.actor != nullptr && best.distance2 <= reach * reach) {
+			break;
+		}
+	}
+	return ActorStore::ToLua(best.actor);
+}
+
+void SpatialIndex::LuaInit() {
+	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
+		.beginNamespace("Actor")
+		.addFunction("FindInRadius", &SpatialIndex::FindInRadius)
+		.addFunction("FindInRect", &SpatialIndex::FindInRect)
+		.addFunction("FindNearest", &SpatialIndex::FindNearest)
+		.endNamespace();
+}
\ No newline at end of file
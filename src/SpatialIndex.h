@@ -0,0 +1,86 @@
+#pragma once
+#include "Actor.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "box2d/box2d.h"
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+/* A spatially hashed uniform grid over every actor with a position: its first Rigidbody, or else the
+   native position a script gave it. An actor that moves, is created or loses its position is only
+   queued; the next query re-files just the queued actors, so a query costs the cells it overlaps and
+   the actors touched since the last one rather than the whole scene. After a physics step everything
+   may have moved, and the grid is rebuilt whole. */
+class SpatialIndex {
+public:
+	static inline float cellSize = 2.0f; // World units, game.config "spatial_cell_size"
+
+	static void Invalidate() { // Anything may have moved; from the physics step
+		SpatialIndex::dirty = true;
+	}
+	static void Touch(Actor* actor); // This actor may have moved, been created or changed its position source
+	static void Remove(Actor* actor); // Before the actor leaves ActorStore
+	static bool PositionOf(Actor* actor, b2Vec2& position);
+
+	static luabridge::LuaRef FindInRadius(float x, float y, float radius, luabridge::LuaRef filter);
+	static luabridge::LuaRef FindInRect(float min_x, float min_y, float max_x, float max_y, luabridge::LuaRef filter);
+	static luabridge::LuaRef FindNearest(float x, float y, luabridge::LuaRef filter);
+
+	static void LuaInit();
+private:
+	static const uint32_t NO_BUCKET = UINT32_MAX;
+	static const int32_t CELL_LIMIT = 1 << 29; // Cells are clamped to +-this, so ring arithmetic stays in int32_t
+
+	struct Entry {
+		float x;
+		float y;
+		int32_t cellX;
+		int32_t cellY;
+		Actor* actor;
+	};
+	/* nil matches everything, a string matches an actor name, and a table may give "name" and/or "type". */
+	struct Filter {
+		std::string name;
+		std::string type;
+		bool Matches(Actor* actor) const;
+	};
+
+	static inline bool dirty = true;
+	static inline std::vector<std::vector<Entry>> buckets; // Power-of-two count; each keeps its capacity across rebuilds
+	static inline size_t entryCount = 0;
+	static inline std::vector<ActorHandle> pending; // Touched since the last query
+	static inline int32_t minCellX = 0; // Bounds of the occupied cells; only grow between rebuilds
+	static inline int32_t minCellY = 0;
+	static inline int32_t maxCellX = -1;
+	static inline int32_t maxCellY = -1;
+
+	static void Refresh(); // Before every query
+	static void Rebuild();
+	static void Place(Actor* actor, float x, float y);
+	static void Unplace(Actor* actor);
+	static int32_t CellOf(float coordinate) {
+		// Clamped before the cast, which is undefined for NaN and for anything outside int32_t.
+		float cell = std::floor(coordinate / SpatialIndex::cellSize);
+		if (!(cell > -CELL_LIMIT)) {
+			return -CELL_LIMIT;
+		}
+		if (cell > CELL_LIMIT) {
+			return CELL_LIMIT;
+		}
+		return static_cast<int32_t>(cell);
+	}
+	static uint32_t Bucket(int32_t cell_x, int32_t cell_y) {
+		return (static_cast<uint32_t>(cell_x) * 73856093u ^ static_cast<uint32_t>(cell_y) * 19349663u)
+			& static_cast<uint32_t>(SpatialIndex::buckets.size() - 1);
+	}
+	template <class Visit>
+	static void VisitCells(int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y, const Visit& visit);
+	template <class Visit>
+	static void VisitAll(const Visit& visit);
+	static Filter ParseFilter(const luabridge::LuaRef& filter);
+	SpatialIndex() {}
+};
\ No newline at end of file
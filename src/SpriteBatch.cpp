@@ -0,0 +1,75 @@
+#include "SpriteBatch.h"
+
+#include "Helper.h"
+
+#include <cmath>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "SDL2/SDL.h"
+
+void SpriteBatch::Add(SDL_Renderer* renderer, SDL_Texture* image, const SDL_Rect* srcrect, const SDL_FRect& dstrect, float angle, const SDL_FPoint* center,
+	SDL_RendererFlip flip, SDL_Color color) {
+	if (image != this->texture) {
+		this->Flush(renderer);
+		this->texture = image;
+		Helper::SDL_QueryTexture(image, &this->textureW, &this->textureH);
+	}
+
+	// Texture coordinates of the source rect, for images that live in an atlas page.
+	float min_u = 0.0f;
+	float min_v = 0.0f;
+	float max_u = 1.0f;
+	float max_v = 1.0f;
+	if (srcrect != nullptr) {
+		min_u = srcrect->x / this->textureW;
+		min_v = srcrect->y / this->textureH;
+		max_u = (srcrect->x + srcrect->w) / this->textureW;
+		max_v = (srcrect->y + srcrect->h) / this->textureH;
+	}
+
+	// Helper::SDL_RenderCopyEx hands SDL whole pixels, so start from the same truncated rect and pivot.
+	float x = static_cast<float>(static_cast<int>(dstrect.x));
+	float y = static_cast<float>(static_cast<int>(dstrect.y));
+	float w = static_cast<float>(static_cast<int>(dstrect.w));
+	float h = static_cast<float>(static_cast<int>(dstrect.h));
+	float center_x = x + (center != nullptr ? static_cast<float>(static_cast<int>(center->x)) : w / 2.0f);
+	float center_y = y + (center != nullptr ? static_cast<float>(static_cast<int>(center->y)) : h / 2.0f);
+
+	// A flip mirrors the corners rather than the texture coordinates, as SDL does.
+	float min_x = (flip & SDL_FLIP_HORIZONTAL) ? x + w : x;
+	float max_x = (flip & SDL_FLIP_HORIZONTAL) ? x : x + w;
+	float min_y = (flip & SDL_FLIP_VERTICAL) ? y + h : y;
+	float max_y = (flip & SDL_FLIP_VERTICAL) ? y : y + h;
+
+	const float radians = glm::radians(angle);
+	const float s = std::sin(radians);
+	const float c = std::cos(radians);
+	const float s_min_x = s * (min_x - center_x);
+	const float s_min_y = s * (min_y - center_y);
+	const float s_max_x = s * (max_x - center_x);
+	const float s_max_y = s * (max_y - center_y);
+	const float c_min_x = c * (min_x - center_x);
+	const float c_min_y = c * (min_y - center_y);
+	const float c_max_x = c * (max_x - center_x);
+	const float c_max_y = c * (max_y - center_y);
+
+	int first = static_cast<int>(this->vertices.size());
+	this->vertices.push_back({ { (c_min_x - s_min_y) + center_x, (s_min_x + c_min_y) + center_y }, color, { min_u, min_v } });
+	this->vertices.push_back({ { (c_max_x - s_min_y) + center_x, (s_max_x + c_min_y) + center_y }, color, { max_u, min_v } });
+	this->vertices.push_back({ { (c_max_x - s_max_y) + center_x, (s_max_x + c_max_y) + center_y }, color, { max_u, max_v } });
+	this->vertices.push_back({ { (c_min_x - s_max_y) + center_x, (s_min_x + c_max_y) + center_y }, color, { min_u, max_v } });
+	for (int corner : { 0, 1, 2, 0, 2, 3 }) {
+		this->indices.push_back(first + corner);
+	}
+}
+
+void SpriteBatch::Flush(SDL_Renderer* renderer) {
+	if (!this->vertices.empty()) {
+		Helper::SDL_RenderGeometry(renderer, this->texture, this->vertices.data(), static_cast<int>(this->vertices.size()),
+			this->indices.data(), static_cast<int>(this->indices.size()));
+	}
+	this->vertices.clear();
+	this->indices.clear();
+	this->texture = nullptr;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+
+#include "SDL2/SDL.h"
+
+/* Images turned into textured quads on the CPU, the way SDL_RenderCopyEx builds them when it falls back
+   on geometry: same integer truncation, rotation about the pivot, flip and color. Consecutive images
+   that share a texture go out in one SDL_RenderGeometry call. */
+class SpriteBatch {
+public:
+	void Add(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* srcrect, const SDL_FRect& dstrect, float angle, const SDL_FPoint* center,
+		SDL_RendererFlip flip, SDL_Color color);
+	void Flush(SDL_Renderer* renderer); // Draws whatever is queued, under the renderer's current scale
+private:
+	SDL_Texture* texture = nullptr;
+	float textureW = 1.0f;
+	float textureH = 1.0f;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+};
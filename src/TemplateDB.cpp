@@ -1,5 +1,6 @@
 #include "Actor.h"
 #include "ComponentDB.h"
+#include "CookedScene.h"
 #include "EngineUtils.h"
 #include "TemplateDB.h"
 
@@ -19,40 +20,91 @@ bool TemplateDB::DoesntDestroyOnLoad(const std::string& templateName) {
 	}
 }
 
+void TemplateDB::ResetToTemplate(Actor& actor, const std::string& templateName) {
+	Actor* templateActor = &(TemplateDB::templateMap.at(templateName));
+	actor.ApplyTemplate(*templateActor);
+	ComponentDB::ComponentReset(&actor, templateActor);
+}
+
 void TemplateDB::LoadTemplate(Actor& actor, const std::string& templateName) {
 	if (TemplateDB::templateMap.find(templateName) != TemplateDB::templateMap.end()) {
 		Actor* templateActor = &(TemplateDB::templateMap[templateName]);
-		actor = Actor(*templateActor);
+		actor.ApplyTemplate(*templateActor);
 		ComponentDB::ComponentCopy(&actor, templateActor);
 	}
 	else {
-		rapidjson::Document templateJson;
-		std::string templatePath = "resources/actor_templates/" + templateName + ".template";
-		if (!std::filesystem::exists(templatePath)) {
-			std::cout << "error: template " + templateName + " is missing";
-			std::exit(0);
-		}
+		Actor* templateActor = TemplateDB::ReadTemplate(templateName);
+		actor.ApplyTemplate(*templateActor);
+		ComponentDB::ComponentCopy(&actor, templateActor);
+	}
+}
+
+Actor* TemplateDB::ReadTemplate(const std::string& templateName) {
+	CookedFile cooked;
+	if (cooked.Open(CookedScene::TemplatePath(templateName), COOKED_TEMPLATE) && cooked.ActorCount() == 1) {
+		return TemplateDB::BuildTemplate(templateName, cooked);
+	}
 
-		ReadJsonFile(templatePath, templateJson);
-		Actor templateActor = Actor();
+	rapidjson::Document templateJson;
+	std::string templatePath = "resources/actor_templates/" + templateName + ".template";
+	if (!std::filesystem::exists(templatePath)) {
+		std::cout << "error: template " + templateName + " is missing";
+		std::exit(0);
+	}
 
-		if (templateJson.HasMember("name")) {
-			templateActor.SetName(std::string(templateJson["name"].GetString()));
-		}
+	ReadJsonFile(templatePath, templateJson);
+	return TemplateDB::BuildTemplate(templateName, templateJson);
+}
+
+void TemplateDB::Preload(const std::string& templateName, rapidjson::Document& templateJson) {
+	if (TemplateDB::templateMap.find(templateName) == TemplateDB::templateMap.end()) {
+		TemplateDB::BuildTemplate(templateName, templateJson);
+	}
+}
 
-		if (templateJson.HasMember("components")) {
-			for (auto itr = templateJson["components"].MemberBegin();
-				itr != templateJson["components"].MemberEnd(); ++itr) {
-				if (itr->value.HasMember("type")) {
-					ComponentDB::LoadComponent(&templateActor,
-						itr->value["type"].GetString(),
-						itr->name.GetString(), itr);
-				}
+void TemplateDB::Preload(const std::string& templateName) {
+	if (TemplateDB::templateMap.find(templateName) == TemplateDB::templateMap.end()) {
+		TemplateDB::ReadTemplate(templateName);
+	}
+}
+
+Actor* TemplateDB::BuildTemplate(const std::string& templateName, rapidjson::Document& templateJson) {
+	Actor templateActor = Actor();
+
+	if (templateJson.HasMember("name")) {
+		templateActor.SetName(std::string(templateJson["name"].GetString()));
+	}
+
+	if (templateJson.HasMember("components")) {
+		for (auto itr = templateJson["components"].MemberBegin();
+			itr != templateJson["components"].MemberEnd(); ++itr) {
+			if (itr->value.HasMember("type")) {
+				ComponentDB::LoadComponent(&templateActor,
+					itr->value["type"].GetString(),
+					itr->name.GetString(), itr);
 			}
 		}
+	}
 
-		actor = Actor(templateActor);
-		ComponentDB::ComponentCopy(&actor, &templateActor);
-		TemplateDB::templateMap[templateName] = templateActor;
+	TemplateDB::templateMap[templateName] = templateActor;
+	return &(TemplateDB::templateMap[templateName]);
+}
+
+Actor* TemplateDB::BuildTemplate(const std::string& templateName, const CookedFile& cooked) {
+	Actor templateActor = Actor();
+	const CookedActor& cookedActor = cooked.ActorAt(0);
+
+	if (cookedActor.name != COOKED_NONE) {
+		templateActor.SetName(cooked.String(cookedActor.name));
 	}
+
+	for (uint32_t i = 0; i < cookedActor.componentCount; i++) {
+		const CookedComponent& component = cooked.ComponentAt(cookedActor.firstComponent + i);
+		if (component.type != COOKED_NONE) {
+			ComponentDB::LoadCookedComponent(&templateActor, cooked, component);
+		}
+	}
+
+	TemplateDB::templateMap[templateName] = templateActor;
+	return &(TemplateDB::templateMap[templateName]);
 }
\ No newline at end of file
@@ -1,14 +1,23 @@
 #pragma once
 #include "Actor.h"
+#include "CookedScene.h"
 
 #include <string>
 #include <unordered_map>
 
+#include "rapidjson/document.h"
+
 class TemplateDB {
 public:
 	static void LoadTemplate(Actor& actor, const std::string& templateName);
+	static void ResetToTemplate(Actor& actor, const std::string& templateName); // Needs the same components
+	static void Preload(const std::string& templateName, rapidjson::Document& templateJson); // Parsed elsewhere
+	static void Preload(const std::string& templateName);
 	static bool DoesntDestroyOnLoad(const std::string& templateName);
 private:
+	static Actor* ReadTemplate(const std::string& templateName); // Cooked if there is a fresh cooked file
+	static Actor* BuildTemplate(const std::string& templateName, rapidjson::Document& templateJson);
+	static Actor* BuildTemplate(const std::string& templateName, const CookedFile& cooked);
 	static inline std::unordered_map<std::string, Actor> templateMap;
 	TemplateDB() {}
 };
\ No newline at end of file
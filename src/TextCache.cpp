@@ -0,0 +1,149 @@
+#include "SpriteBatch.h"
+#include "TextCache.h"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SDL2/SDL.h"
+#include "SDL2_TTF/SDL_ttf.h"
+
+const SDL_Color GLYPH_WHITE = { 255, 255, 255, 255 };
+const int GLYPH_ATLAS_WIDTH = 1024;
+
+SDL_Texture* TextCache::StringTexture(SDL_Renderer* renderer, TTF_Font* font, const std::string& content) {
+	StringKey key(font, content);
+	auto it = TextCache::strings.find(key);
+	if (it != TextCache::strings.end()) {
+		TextCache::recent.splice(TextCache::recent.begin(), TextCache::recent, it->second);
+		return it->second->texture;
+	}
+
+	SDL_Surface* surface = TTF_RenderText_Solid(font, content.c_str(), GLYPH_WHITE);
+	if (surface == nullptr) {
+		return nullptr;
+	}
+	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_FreeSurface(surface);
+	if (texture == nullptr) {
+		return nullptr;
+	}
+
+	while (!TextCache::recent.empty() && TextCache::recent.size() >= std::max<size_t>(TextCache::capacity, 1)) {
+		SDL_DestroyTexture(TextCache::recent.back().texture);
+		TextCache::strings.erase(TextCache::recent.back().key);
+		TextCache::recent.pop_back();
+	}
+	TextCache::recent.push_front({ key, texture });
+	TextCache::strings.emplace(std::move(key), TextCache::recent.begin());
+	return texture;
+}
+
+TextCache::GlyphAtlas& TextCache::AtlasFor(SDL_Renderer* renderer, TTF_Font* font) {
+	auto it = TextCache::glyphAtlases.find(font);
+	if (it != TextCache::glyphAtlases.end()) {
+		return it->second;
+	}
+
+	GlyphAtlas& atlas = TextCache::glyphAtlases[font];
+	std::vector<std::pair<Uint16, SDL_Surface*>> cells;
+	for (Uint16 ch = 32; ch < 256; ch++) {
+		int min_x = 0;
+		int advance = 0;
+		if (!TTF_GlyphIsProvided(font, ch) || TTF_GlyphMetrics(font, ch, &min_x, nullptr, nullptr, nullptr, &advance) != 0) {
+			continue;
+		}
+		Glyph& glyph = atlas.glyphs[ch];
+		glyph.overhang = std::min(min_x, 0);
+		glyph.advance = advance;
+		glyph.present = true;
+
+		// A space renders to nothing, but still advances the pen.
+		SDL_Surface* rendered = TTF_RenderGlyph_Solid(font, ch, GLYPH_WHITE);
+		SDL_Surface* cell = rendered != nullptr ? SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+		SDL_FreeSurface(rendered);
+		if (cell != nullptr) {
+			cells.emplace_back(ch, cell);
+		}
+	}
+
+	// A limit of 0 means the renderer has none.
+	SDL_RendererInfo info;
+	int max_width = GLYPH_ATLAS_WIDTH;
+	int max_height = INT_MAX;
+	if (SDL_GetRendererInfo(renderer, &info) == 0) {
+		if (info.max_texture_width > 0) {
+			max_width = std::min(max_width, info.max_texture_width);
+		}
+		if (info.max_texture_height > 0) {
+			max_height = info.max_texture_height;
+		}
+	}
+
+	// Every cell is the font's height, so plain shelves pack them as well as anything would.
+	int row_height = TTF_FontHeight(font) + 1;
+	int x = 0;
+	int y = 0;
+	bool fits = true;
+	for (auto& cell : cells) {
+		if (x + cell.second->w > max_width) {
+			x = 0;
+			y += row_height;
+		}
+		if (cell.second->w > max_width || y + row_height > max_height) {
+			fits = false;
+			break;
+		}
+		atlas.glyphs[cell.first].cell = { x, y, cell.second->w, cell.second->h };
+		x += cell.second->w + 1;
+	}
+
+	// A font too big for one page keeps no atlas, and its text is drawn a string at a time instead.
+	if (!cells.empty() && fits) {
+		SDL_Surface* page = SDL_CreateRGBSurfaceWithFormat(0, max_width, y + row_height, 32, SDL_PIXELFORMAT_RGBA32);
+		for (auto& cell : cells) {
+			SDL_SetSurfaceBlendMode(cell.second, SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(cell.second, nullptr, page, &atlas.glyphs[cell.first].cell);
+		}
+		atlas.texture = SDL_CreateTextureFromSurface(renderer, page);
+		SDL_FreeSurface(page);
+	}
+	for (auto& cell : cells) {
+		SDL_FreeSurface(cell.second);
+	}
+	return atlas;
+}
+
+bool TextCache::AddGlyphs(SpriteBatch& batch, SDL_Renderer* renderer, TTF_Font* font, const std::string& content,
+	float x, float y, SDL_Color color) {
+	GlyphAtlas& atlas = TextCache::AtlasFor(renderer, font);
+	if (atlas.texture == nullptr) {
+		return false;
+	}
+
+	bool kerning = TTF_GetFontKerning(font) != 0;
+	int pen = 0;
+	Uint16 previous = 0;
+	for (unsigned char ch : content) {
+		const Glyph& glyph = atlas.glyphs[ch];
+		if (!glyph.present) {
+			continue;
+		}
+		if (kerning && previous != 0) {
+			pen += TTF_GetFontKerningSizeGlyphs(font, previous, ch);
+		}
+		// TTF_RenderText starts the string far enough right that the first glyph's overhang fits.
+		if (previous == 0) {
+			pen = -glyph.overhang;
+		}
+		if (glyph.cell.w > 0) {
+			SDL_FRect rect = { x + pen + glyph.overhang, y, static_cast<float>(glyph.cell.w), static_cast<float>(glyph.cell.h) };
+			batch.Add(renderer, atlas.texture, &glyph.cell, rect, 0.0f, nullptr, SDL_FLIP_NONE, color);
+		}
+		pen += glyph.advance;
+		previous = ch;
+	}
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "SDL2/SDL.h"
+#include "SDL2_TTF/SDL_ttf.h"
+
+class SpriteBatch;
+
+/* Text the renderer has already rasterized, so a string drawn every frame costs a lookup instead of a
+   TTF render and a texture upload. Strings are rendered white and tinted when drawn, so a color change
+   reuses the texture too. Every call runs on the thread owning the renderer. */
+class TextCache {
+public:
+	static inline size_t capacity = 256; // rendering.config "text_cache_size"
+
+	// The string's texture, rendered on a miss; the least recently drawn one is destroyed to make room.
+	// nullptr for text TTF cannot render, such as "".
+	static SDL_Texture* StringTexture(SDL_Renderer* renderer, TTF_Font* font, const std::string& content);
+	// Lays the string out from the font's glyph atlas and queues one quad per glyph. False, with nothing
+	// queued, for a font without an atlas, e.g. one too large for a texture the renderer can hold.
+	static bool AddGlyphs(SpriteBatch& batch, SDL_Renderer* renderer, TTF_Font* font, const std::string& content,
+		float x, float y, SDL_Color color);
+private:
+	using StringKey = std::pair<TTF_Font*, std::string>;
+	struct StringKeyHash {
+		size_t operator()(const StringKey& key) const {
+			return std::hash<std::string>()(key.second) ^ (std::hash<TTF_Font*>()(key.first) << 1);
+		}
+	};
+	struct CachedString {
+		StringKey key;
+		SDL_Texture* texture;
+	};
+	static inline std::list<CachedString> recent; // Most recently drawn first
+	static inline std::unordered_map<StringKey, std::list<CachedString>::iterator, StringKeyHash> strings;
+
+	/* Every Latin-1 glyph of one font, rasterized once into a single texture. Text is Latin-1 to
+	   TTF_RenderText, so this covers anything it would draw. Each cell is a glyph rendered on its own:
+	   font height tall, starting left of the pen when the glyph overhangs it. */
+	struct Glyph {
+		SDL_Rect cell = { 0, 0, 0, 0 };
+		int overhang = 0; // min(minx, 0)
+		int advance = 0;
+		bool present = false;
+	};
+	struct GlyphAtlas {
+		SDL_Texture* texture = nullptr;
+		Glyph glyphs[256];
+	};
+	static inline std::unordered_map<TTF_Font*, GlyphAtlas> glyphAtlases;
+
+	static GlyphAtlas& AtlasFor(SDL_Renderer* renderer, TTF_Font* font);
+	TextCache() {}
+};
@@ -1,4 +1,5 @@
 #include "ComponentDB.h"
+#include "Renderer.h"
 #include "TextDB.h"
 
 #include <filesystem>
@@ -27,7 +28,10 @@ void Draw(const std::string& str_content, float x, float y, const std::string& f
 			std::cout << "error: font " << font_name << " missing";
 			std::exit(0);
 		}
-		auto font = TTF_OpenFont(path.c_str(), font_size);
+		TTF_Font* font = nullptr;
+		Renderer::RunOnRenderThread([&path, &font, font_size]() {
+			font = TTF_OpenFont(path.c_str(), font_size);
+		});
 		auto& map = TextDB::textFonts[font_name];
 		map.insert(std::pair(font_size, font));
 		tex.font = font;
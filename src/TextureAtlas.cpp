@@ -0,0 +1,249 @@
+#include "ImageDB.h"
+#include "Renderer.h"
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SDL2/SDL.h"
+#include "SDL2_Img/SDL_image.h"
+
+int TextureAtlas::Skyline::Fit(size_t index, int w, int h) const {
+	int x = this->segments[index].x;
+	if (x + w > this->width) {
+		return -1;
+	}
+	int y = this->segments[index].y;
+	int remaining = w;
+	for (size_t i = index; remaining > 0 && i < this->segments.size(); i++) {
+		y = std::max(y, this->segments[i].y);
+		if (y + h > this->height) {
+			return -1;
+		}
+		remaining -= this->segments[i].width;
+	}
+	return y;
+}
+
+bool TextureAtlas::Skyline::Insert(int w, int h, SDL_Point& position) {
+	int best_top = INT_MAX;
+	int best_x = INT_MAX;
+	size_t best_index = 0;
+	for (size_t i = 0; i < this->segments.size(); i++) {
+		int y = this->Fit(i, w, h);
+		if (y >= 0 && (y + h < best_top || (y + h == best_top && this->segments[i].x < best_x))) {
+			best_top = y + h;
+			best_x = this->segments[i].x;
+			best_index = i;
+		}
+	}
+	if (best_top == INT_MAX) {
+		return false;
+	}
+
+	position = { best_x, best_top - h };
+	this->segments.insert(this->segments.begin() + best_index, { best_x, best_top, w });
+
+	// Segments now under the new one shrink from the left, or go entirely.
+	size_t next = best_index + 1;
+	while (next < this->segments.size()) {
+		const Segment& placed = this->segments[next - 1];
+		Segment& segment = this->segments[next];
+		int overlap = placed.x + placed.width - segment.x;
+		if (overlap <= 0) {
+			break;
+		}
+		segment.x += overlap;
+		segment.width -= overlap;
+		if (segment.width > 0) {
+			break;
+		}
+		this->segments.erase(this->segments.begin() + next);
+	}
+
+	for (size_t i = 1; i < this->segments.size();) {
+		if (this->segments[i - 1].y == this->segments[i].y) {
+			this->segments[i - 1].width += this->segments[i].width;
+			this->segments.erase(this->segments.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+
+	this->used = std::max(this->used, best_top);
+	return true;
+}
+
+std::vector<std::string> TextureAtlas::GroupOf(const std::string& sceneName) {
+	auto it = TextureAtlas::sceneGroups.find(sceneName);
+	return it != TextureAtlas::sceneGroups.end() ? it->second : std::vector<std::string>();
+}
+
+bool TextureAtlas::NeedsPack(const std::string& sceneName) {
+	// Scenes that share a group keep its pages.
+	return TextureAtlas::enabled && !(TextureAtlas::resident && TextureAtlas::GroupOf(sceneName) == TextureAtlas::residentImages);
+}
+
+void TextureAtlas::UseScene(const std::string& sceneName) {
+	std::unique_ptr<PackedAtlas> packed = std::move(TextureAtlas::prepared);
+	if (!TextureAtlas::NeedsPack(sceneName)) {
+		return;
+	}
+
+	std::vector<std::string> wanted = TextureAtlas::GroupOf(sceneName);
+	if (packed == nullptr || packed->group != wanted) {
+		packed = TextureAtlas::Pack(sceneName);
+	}
+	TextureAtlas::Release();
+	TextureAtlas::Upload(*packed);
+	TextureAtlas::residentImages = std::move(wanted);
+	TextureAtlas::resident = true;
+	ImageDB::ForgetResolved();
+}
+
+void TextureAtlas::Adopt(std::unique_ptr<PackedAtlas> packed) {
+	TextureAtlas::prepared = std::move(packed);
+}
+
+std::vector<std::string> TextureAtlas::ImagesFor(const std::string& sceneName) {
+	if (!TextureAtlas::enabled) {
+		return {};
+	}
+	std::vector<std::string> group = TextureAtlas::GroupOf(sceneName);
+	return group.empty() ? TextureAtlas::AllImages() : group;
+}
+
+std::vector<std::string> TextureAtlas::ResidentNames() {
+	std::vector<std::string> names;
+	names.reserve(TextureAtlas::regions.size());
+	for (auto& region : TextureAtlas::regions) {
+		names.push_back(region.first);
+	}
+	return names;
+}
+
+std::vector<std::string> TextureAtlas::AllImages() {
+	std::vector<std::string> images;
+	std::error_code error;
+	for (auto& entry : std::filesystem::directory_iterator("resources/images", error)) {
+		if (entry.path().extension() == ".png") {
+			images.push_back(entry.path().stem().string());
+		}
+	}
+	// Directory order is up to the filesystem; keep the layout the same from run to run.
+	std::sort(images.begin(), images.end());
+	return images;
+}
+
+std::unique_ptr<PackedAtlas> TextureAtlas::Pack(const std::string& sceneName) {
+	struct Loaded {
+		std::string name;
+		SDL_Surface* surface = nullptr;
+		size_t page = 0;
+		SDL_Point position = { 0, 0 };
+	};
+
+	auto packed = std::make_unique<PackedAtlas>();
+	packed->group = TextureAtlas::GroupOf(sceneName);
+	std::vector<Loaded> loaded;
+	for (auto& name : TextureAtlas::ImagesFor(sceneName)) {
+		if (std::find_if(loaded.begin(), loaded.end(), [&name](const Loaded& l) { return l.name == name; }) != loaded.end()) {
+			continue;
+		}
+		std::string imagePath = "resources/images/" + name + ".png";
+		SDL_Surface* decoded = IMG_Load(imagePath.c_str());
+		if (decoded == nullptr) {
+			continue;
+		}
+		SDL_Surface* surface = SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(decoded);
+		if (surface == nullptr) {
+			continue;
+		}
+		if (surface->w + PADDING > TextureAtlas::pageSize || surface->h + PADDING > TextureAtlas::pageSize) {
+			SDL_FreeSurface(surface);
+			continue;
+		}
+		loaded.push_back({ name, surface });
+	}
+
+	// Tallest first packs a skyline tightest.
+	std::sort(loaded.begin(), loaded.end(), [](const Loaded& a, const Loaded& b) {
+		if (a.surface->h != b.surface->h) {
+			return a.surface->h > b.surface->h;
+		}
+		if (a.surface->w != b.surface->w) {
+			return a.surface->w > b.surface->w;
+		}
+		return a.name < b.name;
+	});
+
+	std::vector<Skyline> skylines;
+	for (auto& image : loaded) {
+		int w = image.surface->w + PADDING;
+		int h = image.surface->h + PADDING;
+		bool placed = false;
+		for (size_t page = 0; page < skylines.size() && !placed; page++) {
+			placed = skylines[page].Insert(w, h, image.position);
+			image.page = page;
+		}
+		if (!placed) {
+			skylines.emplace_back(TextureAtlas::pageSize, TextureAtlas::pageSize);
+			skylines.back().Insert(w, h, image.position);
+			image.page = skylines.size() - 1;
+		}
+	}
+
+	// Pages are cut off below their last row, so a half-full page does not cost a full one.
+	for (auto& skyline : skylines) {
+		packed->pages.push_back(SDL_CreateRGBSurfaceWithFormat(0, skyline.width, skyline.used, 32, SDL_PIXELFORMAT_RGBA32));
+	}
+	for (auto& image : loaded) {
+		SDL_Rect rect = { image.position.x, image.position.y, image.surface->w, image.surface->h };
+		SDL_SetSurfaceBlendMode(image.surface, SDL_BLENDMODE_NONE);
+		SDL_BlitSurface(image.surface, nullptr, packed->pages[image.page], &rect);
+		packed->images.push_back({ image.name, image.page, rect });
+		SDL_FreeSurface(image.surface);
+	}
+	return packed;
+}
+
+void TextureAtlas::Upload(const PackedAtlas& packed) {
+	TextureAtlas::pages.resize(packed.pages.size(), nullptr);
+	Renderer::RunOnRenderThread([&packed]() {
+		for (size_t page = 0; page < packed.pages.size(); page++) {
+			TextureAtlas::pages[page] = SDL_CreateTextureFromSurface(Renderer::renderer_ptr, packed.pages[page]);
+		}
+	});
+
+	for (auto& image : packed.images) {
+		if (TextureAtlas::pages[image.page] != nullptr) {
+			TextureAtlas::regions[image.name] = { TextureAtlas::pages[image.page], image.rect };
+		}
+	}
+}
+
+void TextureAtlas::Release() {
+	TextureAtlas::regions.clear();
+	TextureAtlas::residentImages.clear();
+	TextureAtlas::resident = false;
+	if (TextureAtlas::pages.empty()) {
+		return;
+	}
+
+	// The frame still being drawn may be using these pages.
+	Renderer::WaitForFrame();
+	Renderer::RunOnRenderThread([]() {
+		for (auto page : TextureAtlas::pages) {
+			if (page != nullptr) {
+				SDL_DestroyTexture(page);
+			}
+		}
+	});
+	TextureAtlas::pages.clear();
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SDL2/SDL.h"
+
+/* Where an image lives once packed: a sub-rectangle of one of the atlas's page textures. */
+struct AtlasRegion {
+	SDL_Texture* page = nullptr;
+	SDL_Rect rect = { 0, 0, 0, 0 };
+};
+
+/* A scene's atlas pages, decoded and packed into surfaces but not yet uploaded. Nothing here touches the
+   renderer, so SceneLoader builds one on its worker thread; TextureAtlas::UseScene only uploads it. */
+struct PackedAtlas {
+	struct Image {
+		std::string name;
+		size_t page;
+		SDL_Rect rect;
+	};
+	std::vector<std::string> group; // The scene's "atlas_groups" entry; empty for every image
+	std::vector<SDL_Surface*> pages;
+	std::vector<Image> images;
+
+	PackedAtlas() {}
+	PackedAtlas(const PackedAtlas&) = delete;
+	PackedAtlas& operator=(const PackedAtlas&) = delete;
+	~PackedAtlas() {
+		for (auto page : this->pages) {
+			SDL_FreeSurface(page);
+		}
+	}
+};
+
+/* Packs images under resources/images into a few large page textures, so consecutive draws of different
+   images can share a texture (and a batch). One group of images is resident at a time: the images a scene
+   lists under "atlas_groups" in rendering.config, or every image when the scene lists none. Images left out,
+   or too big for a page, keep their own textures in ImageDB::imageMap. */
+class TextureAtlas {
+public:
+	static inline bool enabled = false; // rendering.config "texture_atlas"
+	static inline int pageSize = 2048; // rendering.config "atlas_page_size"
+	static inline std::unordered_map<std::string, std::vector<std::string>> sceneGroups; // rendering.config "atlas_groups"
+
+	static void UseScene(const std::string& sceneName); // From SceneDB::BeginSceneLoad, at the top of a frame
+	static bool NeedsPack(const std::string& sceneName); // False when UseScene would keep the resident pages
+	static std::vector<std::string> ImagesFor(const std::string& sceneName); // What UseScene will pack for the scene
+	static std::unique_ptr<PackedAtlas> Pack(const std::string& sceneName); // Safe off the main thread
+	static void Adopt(std::unique_ptr<PackedAtlas> packed); // Packed elsewhere; the next UseScene for its group uploads it
+	static std::vector<std::string> ResidentNames(); // Images on the resident pages
+	static const AtlasRegion* Find(const std::string& image_name) {
+		auto it = TextureAtlas::regions.find(image_name);
+		return it != TextureAtlas::regions.end() ? &it->second : nullptr;
+	}
+	static int GetPageCount() {
+		return static_cast<int>(TextureAtlas::pages.size());
+	}
+private:
+	static const int PADDING = 1; // Transparent pixels around each image
+
+	/* A skyline packer for one page: the top edge of everything placed so far, as a run of horizontal
+	   segments. Each image goes where its top would sit lowest, leftmost on ties. */
+	struct Skyline {
+		struct Segment {
+			int x;
+			int y;
+			int width;
+		};
+		std::vector<Segment> segments;
+		int width = 0;
+		int height = 0;
+		int used = 0; // Lowest row that is still empty
+
+		Skyline(int width, int height) : segments({ { 0, 0, width } }), width(width), height(height) {}
+		bool Insert(int w, int h, SDL_Point& position);
+	private:
+		int Fit(size_t index, int w, int h) const; // y the image would sit at, or -1
+	};
+
+	static inline bool resident = false;
+	static inline std::vector<std::string> residentImages; // Empty with resident set means every image
+	static inline std::vector<SDL_Texture*> pages;
+	static inline std::unordered_map<std::string, AtlasRegion> regions;
+	static inline std::unique_ptr<PackedAtlas> prepared; // From Adopt, waiting on UseScene
+
+	static std::vector<std::string> GroupOf(const std::string& sceneName);
+	static std::vector<std::string> AllImages();
+	static void Upload(const PackedAtlas& packed);
+	static void Release();
+	TextureAtlas() {}
+};
@@ -0,0 +1,136 @@
+#include "ComponentDB.h"
+#include "Time.h"
+
+#include "Helper.h"
+
+#include <cmath>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "SDL2/SDL.h"
+
+float Time::FIXED_DELTA_TIME = 1.0f / 60.0f;
+int Time::MAX_FIXED_STEPS = 8;
+float Time::MAX_DELTA_TIME = 0.25f;
+bool Time::lockstep = false;
+float Time::timeScale = 1.0f;
+float Time::deltaTime = 0.0f;
+float Time::unscaledDeltaTime = 0.0f;
+float Time::interpolationAlpha = 0.0f;
+double Time::time = 0.0;
+double Time::unscaledTime = 0.0;
+double Time::fixedTime = 0.0;
+int Time::fixedStepsThisFrame = 0;
+Uint64 Time::startCounter = 0;
+Uint64 Time::lastCounter = 0;
+double Time::accumulator = 0.0;
+
+float GetDeltaTime() {
+	return Time::deltaTime;
+}
+
+float GetUnscaledDeltaTime() {
+	return Time::unscaledDeltaTime;
+}
+
+float GetFixedDeltaTime() {
+	return Time::FIXED_DELTA_TIME;
+}
+
+float GetTime() {
+	return static_cast<float>(Time::time);
+}
+
+float GetUnscaledTime() {
+	return static_cast<float>(Time::unscaledTime);
+}
+
+float GetFixedTime() {
+	return static_cast<float>(Time::fixedTime);
+}
+
+double GetRealtime() {
+	return Time::GetRealtime();
+}
+
+float GetTimeScale() {
+	return Time::timeScale;
+}
+
+void SetTimeScale(float scale) {
+	if (scale < 0.0f) {
+		scale = 0.0f;
+	}
+	Time::timeScale = scale;
+}
+
+float GetInterpolationAlpha() {
+	return Time::interpolationAlpha;
+}
+
+void Time::Init() {
+	Time::startCounter = SDL_GetPerformanceCounter();
+	Time::lastCounter = Time::startCounter;
+	Time::accumulator = 0.0;
+}
+
+void Time::BeginFrame() {
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	if (Helper::_autograder_mode || Time::lockstep) {
+		// Replays and benchmarks must be frame-exact, so every frame advances exactly one tick.
+		Time::unscaledDeltaTime = Time::FIXED_DELTA_TIME;
+	}
+	else {
+		Time::unscaledDeltaTime = static_cast<float>(
+			static_cast<double>(now - Time::lastCounter) / SDL_GetPerformanceFrequency());
+		if (Time::unscaledDeltaTime > Time::MAX_DELTA_TIME) {
+			Time::unscaledDeltaTime = Time::MAX_DELTA_TIME;
+		}
+	}
+	Time::lastCounter = now;
+
+	Time::deltaTime = Time::unscaledDeltaTime * Time::timeScale;
+	Time::unscaledTime += Time::unscaledDeltaTime;
+	Time::time += Time::deltaTime;
+	Time::accumulator += Time::deltaTime;
+	Time::fixedStepsThisFrame = 0;
+}
+
+bool Time::ConsumeFixedStep() {
+	if (Time::accumulator >= Time::FIXED_DELTA_TIME
+		&& Time::fixedStepsThisFrame >= Time::MAX_FIXED_STEPS) {
+		// Too far behind to catch up; drop the backlog so the game slows down instead of stalling.
+		Time::accumulator = std::fmod(Time::accumulator, static_cast<double>(Time::FIXED_DELTA_TIME));
+	}
+
+	if (Time::accumulator < Time::FIXED_DELTA_TIME) {
+		Time::interpolationAlpha = static_cast<float>(Time::accumulator / Time::FIXED_DELTA_TIME);
+		return false;
+	}
+
+	Time::accumulator -= Time::FIXED_DELTA_TIME;
+	Time::fixedTime += Time::FIXED_DELTA_TIME;
+	Time::fixedStepsThisFrame++;
+	return true;
+}
+
+double Time::GetRealtime() {
+	return static_cast<double>(SDL_GetPerformanceCounter() - Time::startCounter) / SDL_GetPerformanceFrequency();
+}
+
+void Time::LuaInit() {
+	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
+		.beginNamespace("Time")
+		.addFunction("GetDeltaTime", &GetDeltaTime)
+		.addFunction("GetUnscaledDeltaTime", &GetUnscaledDeltaTime)
+		.addFunction("GetFixedDeltaTime", &GetFixedDeltaTime)
+		.addFunction("GetTime", &GetTime)
+		.addFunction("GetUnscaledTime", &GetUnscaledTime)
+		.addFunction("GetFixedTime", &GetFixedTime)
+		.addFunction("GetRealtime", &GetRealtime)
+		.addFunction("GetTimeScale", &GetTimeScale)
+		.addFunction("SetTimeScale", &SetTimeScale)
+		.addFunction("GetInterpolationAlpha", &GetInterpolationAlpha)
+		.endNamespace();
+}
\ No newline at end of file
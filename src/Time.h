@@ -0,0 +1,29 @@
+#pragma once
+#include "SDL2/SDL.h"
+
+class Time {
+public:
+	static float FIXED_DELTA_TIME; // Seconds of simulation per physics tick
+	static int MAX_FIXED_STEPS; // Cap on catch-up ticks in a single frame
+	static float MAX_DELTA_TIME; // Frame deltas are clamped to this (debugger pauses, window drags)
+	static bool lockstep; // One fixed tick per frame regardless of wall clock (replays, benchmarks)
+	static float timeScale;
+	static float deltaTime;
+	static float unscaledDeltaTime;
+	static float interpolationAlpha;
+	static double time;
+	static double unscaledTime;
+	static double fixedTime;
+	static int fixedStepsThisFrame;
+
+	static void Init();
+	static void BeginFrame();
+	static bool ConsumeFixedStep();
+	static double GetRealtime();
+	static void LuaInit();
+private:
+	static Uint64 startCounter;
+	static Uint64 lastCounter;
+	static double accumulator;
+	Time() {}
+};
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "Actor.h"
+#include "ComponentDB.h"
+#include "HookTable.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "SpatialIndex.h"
+#include "UpdateScheduler.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "box2d/box2d.h"
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+void UpdateScheduler::BeginFrame() {
+	UpdateScheduler::frame++;
+	if (UpdateScheduler::frame == 0) {
+		UpdateScheduler::frame = 1; // Actors start at viewFrame 0, which must never look current
+	}
+
+	UpdateScheduler::cameraX = Renderer::cameraPos.x;
+	UpdateScheduler::cameraY = Renderer::cameraPos.y;
+	float units_to_pixels = Renderer::UNIT_TO_PIXELS_CONVERSION * Renderer::RENDER_SCALE;
+	UpdateScheduler::halfWidth = Renderer::WINDOW_CENTER.x / units_to_pixels + UpdateScheduler::visibleMargin;
+	UpdateScheduler::halfHeight = Renderer::WINDOW_CENTER.y / units_to_pixels + UpdateScheduler::visibleMargin;
+}
+
+void UpdateScheduler::Measure(Actor* actor) {
+	actor->viewFrame = UpdateScheduler::frame;
+	b2Vec2 position;
+	actor->viewLocated = SpatialIndex::PositionOf(actor, position);
+	if (!actor->viewLocated) {
+		actor->viewOnScreen = true;
+		actor->viewDistance2 = 0.0f;
+		return;
+	}
+
+	float dx = position.x - UpdateScheduler::cameraX;
+	float dy = position.y - UpdateScheduler::cameraY;
+	actor->viewDistance2 = dx * dx + dy * dy;
+	actor->viewOnScreen = std::abs(dx) <= UpdateScheduler::halfWidth && std::abs(dy) <= UpdateScheduler::halfHeight;
+}
+
+bool UpdateScheduler::IsOnScreen(Actor* actor) {
+	if (actor->viewFrame != UpdateScheduler::frame) {
+		UpdateScheduler::Measure(actor);
+	}
+	return actor->viewOnScreen;
+}
+
+bool UpdateScheduler::IsDueGated(Actor* actor, const UpdatePolicy& policy) {
+	// The low half of hookOrder is the actor ID, so instances of one type fall on different frames.
+	if (policy.every > 1 && (UpdateScheduler::frame + static_cast<uint32_t>(actor->hookOrder)) % policy.every != 0) {
+		return false;
+	}
+	if (policy.radius2 <= 0.0f && !policy.whenVisible) {
+		return true;
+	}
+
+	if (actor->viewFrame != UpdateScheduler::frame) {
+		UpdateScheduler::Measure(actor);
+	}
+	if (policy.radius2 > 0.0f && actor->viewDistance2 > policy.radius2) {
+		return false;
+	}
+	return !policy.whenVisible || actor->viewOnScreen;
+}
+
+void UpdateScheduler::DispatchVisibility() {
+	PROFILE_SCOPE("VisibilityPhase");
+	// A component with both hooks is handled in the first pass, so the second only sees those with OnBecameInvisible alone.
+	for (int pass = 0; pass < 2; pass++) {
+		HOOK_TYPE hook = pass == 0 ? HOOK_BECAME_VISIBLE : HOOK_BECAME_INVISIBLE;
+		for (auto& entry : HookTable::Entries(hook)) {
+			Component& component = *entry.component;
+			if (pass == 1 && component.HasHook(HOOK_BECAME_VISIBLE)) {
+				continue;
+			}
+			bool on_screen = UpdateScheduler::IsOnScreen(entry.actor);
+			if (on_screen == component.onScreen) {
+				continue;
+			}
+			component.onScreen = on_screen;
+
+			HOOK_TYPE fired = on_screen ? HOOK_BECAME_VISIBLE : HOOK_BECAME_INVISIBLE;
+			if (!component.HasHook(fired) || !component.IsEnabled()) {
+				continue;
+			}
+			ProfileScope scope(Component::HOOK_NAMES[fired]);
+			ComponentDB::TagScope(scope, entry.actor, component);
+			try {
+				component.Invoke(fired);
+			}
+			catch (const luabridge::LuaException& e) {
+				ComponentDB::ReportError(entry.actor->GetName(), e);
+			}
+		}
+	}
+}
\ No newline at end of file
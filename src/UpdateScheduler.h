@@ -0,0 +1,30 @@
+#pragma once
+#include "Actor.h"
+#include "Component.h"
+
+#include <cstdint>
+
+/* Gates OnUpdate and OnLateUpdate by each component's UpdatePolicy, and tells components when their actor
+   comes onto or leaves the screen. An actor's distance and visibility are measured at most once a frame,
+   on the first entry that asks; an actor with no position is never held back and always counts as visible. */
+class UpdateScheduler {
+public:
+	static inline float visibleMargin = 1.0f; // World units past the screen edge still on screen, game.config "visible_margin"
+
+	static void BeginFrame();
+	static bool IsDue(Actor* actor, const Component& component) {
+		return !component.policy.Gated() || UpdateScheduler::IsDueGated(actor, component.policy);
+	}
+	static bool IsOnScreen(Actor* actor);
+	static void DispatchVisibility(); // OnBecameVisible and OnBecameInvisible, once BeginFrame has run
+private:
+	static inline uint32_t frame = 0;
+	static inline float cameraX = 0.0f;
+	static inline float cameraY = 0.0f;
+	static inline float halfWidth = 0.0f; // Of the visible area in world units, margin included
+	static inline float halfHeight = 0.0f;
+
+	static bool IsDueGated(Actor* actor, const UpdatePolicy& policy);
+	static void Measure(Actor* actor);
+	UpdateScheduler() {}
+};
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "ComponentDB.h"
+#include "Renderer.h"
+#include "SceneDB.h"
+#include "SceneLoader.h"
+#include "WorldStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+// Reads "<x>_<y>" off the end of a scene name that starts with "<prefix>_".
+bool ParseCell(const std::string& sceneName, const std::string& prefix, int32_t& x, int32_t& y) {
+	if (sceneName.size() <= prefix.size() + 1 || sceneName.compare(0, prefix.size(), prefix) != 0 || sceneName[prefix.size()] != '_') {
+		return false;
+	}
+	const char* start = sceneName.c_str() + prefix.size() + 1;
+	char* end = nullptr;
+	long cell_x = std::strtol(start, &end, 10);
+	if (end == start || *end != '_') {
+		return false;
+	}
+	start = end + 1;
+	long cell_y = std::strtol(start, &end, 10);
+	if (end == start || *end != '\0') {
+		return false;
+	}
+	x = static_cast<int32_t>(cell_x);
+	y = static_cast<int32_t>(cell_y);
+	return true;
+}
+
+int32_t Chebyshev(int32_t ax, int32_t ay, int32_t bx, int32_t by) {
+	return std::max(std::abs(ax - bx), std::abs(ay - by));
+}
+
+void WorldStreamer::Start(const std::string& prefix, float cell_size, int load_radius, int unload_radius) {
+	WorldStreamer::Stop();
+	if (cell_size <= 0.0f || load_radius < 0) {
+		return;
+	}
+
+	WorldStreamer::cellSize = cell_size;
+	WorldStreamer::loadRadius = load_radius;
+	// Unloading further out than loading keeps a camera on a cell edge from thrashing it.
+	WorldStreamer::unloadRadius = std::max(unload_radius, load_radius + 1);
+
+	std::error_code error;
+	for (auto& entry : std::filesystem::directory_iterator("resources/scenes", error)) {
+		if (entry.path().extension() != ".scene") {
+			continue;
+		}
+		std::string sceneName = entry.path().stem().string();
+		int32_t x = 0;
+		int32_t y = 0;
+		if (ParseCell(sceneName, prefix, x, y)) {
+			WorldStreamer::cells[WorldStreamer::Key(x, y)] = sceneName;
+		}
+	}
+
+	WorldStreamer::active = true;
+	WorldStreamer::scene = SceneDB::currentScene;
+	WorldStreamer::settled = false;
+}
+
+void WorldStreamer::Stop() {
+	for (auto key : WorldStreamer::streamed) {
+		SceneDB::UnloadAdditive(WorldStreamer::cells[key]);
+	}
+	WorldStreamer::Reset();
+}
+
+void WorldStreamer::Reset() {
+	WorldStreamer::active = false;
+	WorldStreamer::cells.clear();
+	WorldStreamer::streamed.clear();
+}
+
+int WorldStreamer::GetLoadedCount() {
+	int loaded = 0;
+	for (auto key : WorldStreamer::streamed) {
+		if (SceneDB::subScenes.find(WorldStreamer::cells[key]) != SceneDB::subScenes.end()) {
+			loaded++;
+		}
+	}
+	return loaded;
+}
+
+void WorldStreamer::Update() {
+	// Cells are requested against the scene they were started in, so wait out a scene swap, and stop
+	// once it has happened: the swap took every cell with it.
+	if (!WorldStreamer::active || SceneLoader::IsLoading()) {
+		return;
+	}
+	if (SceneDB::currentScene != WorldStreamer::scene) {
+		WorldStreamer::Reset();
+		return;
+	}
+
+	int32_t camera_x = static_cast<int32_t>(std::floor(Renderer::cameraPos.x / WorldStreamer::cellSize));
+	int32_t camera_y = static_cast<int32_t>(std::floor(Renderer::cameraPos.y / WorldStreamer::cellSize));
+	uint64_t camera_cell = WorldStreamer::Key(camera_x, camera_y);
+	if (camera_cell != WorldStreamer::lastCell) {
+		WorldStreamer::lastCell = camera_cell;
+		WorldStreamer::settled = false;
+	}
+	if (WorldStreamer::settled) {
+		return;
+	}
+
+	// A cell that is neither loaded nor loading was unloaded or cancelled behind our back; forget it,
+	// so it is asked for again if it is still in range.
+	int in_flight = 0;
+	std::vector<uint64_t> leaving;
+	for (auto key : WorldStreamer::streamed) {
+		const std::string& sceneName = WorldStreamer::cells[key];
+		bool loading = SceneLoader::IsLoadingAdditive(sceneName);
+		if (!loading && SceneDB::subScenes.find(sceneName) == SceneDB::subScenes.end()) {
+			leaving.push_back(key);
+		}
+		else if (Chebyshev(WorldStreamer::KeyX(key), WorldStreamer::KeyY(key), camera_x, camera_y) > WorldStreamer::unloadRadius) {
+			SceneDB::UnloadAdditive(sceneName);
+			leaving.push_back(key);
+		}
+		else if (loading) {
+			in_flight++;
+		}
+	}
+	for (auto key : leaving) {
+		WorldStreamer::streamed.erase(key);
+	}
+
+	std::vector<std::pair<int32_t, uint64_t>> wanted;
+	for (int32_t y = camera_y - WorldStreamer::loadRadius; y <= camera_y + WorldStreamer::loadRadius; y++) {
+		for (int32_t x = camera_x - WorldStreamer::loadRadius; x <= camera_x + WorldStreamer::loadRadius; x++) {
+			uint64_t key = WorldStreamer::Key(x, y);
+			if (WorldStreamer::cells.find(key) != WorldStreamer::cells.end() && WorldStreamer::streamed.find(key) == WorldStreamer::streamed.end()) {
+				wanted.emplace_back(Chebyshev(x, y, camera_x, camera_y), key);
+			}
+		}
+	}
+	std::sort(wanted.begin(), wanted.end());
+
+	size_t started = 0;
+	while (started < wanted.size() && in_flight < WorldStreamer::maxLoadsInFlight) {
+		uint64_t key = wanted[started].second;
+		SceneLoader::LoadAdditiveAsync(WorldStreamer::cells[key]);
+		WorldStreamer::streamed.insert(key);
+		in_flight++;
+		started++;
+	}
+
+	// Loads in flight still need watching, in case one is cancelled.
+	WorldStreamer::settled = started == wanted.size() && in_flight == 0;
+}
+
+void WorldStreamer::LuaInit() {
+	luabridge::getGlobalNamespace(ComponentDB::GetLuaState())
+		.beginNamespace("Scene")
+		.addFunction("StartStreaming", &WorldStreamer::Start)
+		.addFunction("StopStreaming", &WorldStreamer::Stop)
+		.addFunction("IsStreaming", &WorldStreamer::IsStreaming)
+		.addFunction("GetStreamedCount", &WorldStreamer::GetLoadedCount)
+		.endNamespace();
+}
\ No newline at end of file
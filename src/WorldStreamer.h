@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+/* Streams a world cut into square cells, each its own scene named <prefix>_<x>_<y>. Cells within
+   loadRadius of the camera's cell are loaded additively through SceneLoader, nearest first, and a
+   cell is unloaded once the camera is more than unloadRadius cells away. Streaming ends with the
+   scene it was started in. */
+class WorldStreamer {
+public:
+	static inline int maxLoadsInFlight = 2; // game.config "stream_max_loads"
+
+	static void Start(const std::string& prefix, float cell_size, int load_radius, int unload_radius);
+	static void Stop(); // Unloads every streamed cell
+	static bool IsStreaming() {
+		return WorldStreamer::active;
+	}
+	static int GetLoadedCount();
+	static void Update(); // Once per frame, before SceneLoader::Update
+	static void LuaInit();
+private:
+	static inline bool active = false;
+	static inline std::string scene; // currentScene when Start was called
+	static inline float cellSize = 1.0f;
+	static inline int loadRadius = 0;
+	static inline int unloadRadius = 1;
+	static inline std::unordered_map<uint64_t, std::string> cells; // Every cell with a scene, found once by Start
+	static inline std::unordered_set<uint64_t> streamed; // Loaded or on their way
+	static inline uint64_t lastCell = 0;
+	static inline bool settled = false; // Nothing left to do until the camera changes cell
+
+	static uint64_t Key(int32_t x, int32_t y) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+	static int32_t KeyX(uint64_t key) {
+		return static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+	}
+	static int32_t KeyY(uint64_t key) {
+		return static_cast<int32_t>(static_cast<uint32_t>(key));
+	}
+	static void Reset();
+	WorldStreamer() {}
+};
\ No newline at end of file
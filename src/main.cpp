@@ -1,3 +1,4 @@
+#include "Benchmark.h"
 #include "Engine.h"
 
 #include <iostream>
@@ -5,6 +6,15 @@
 
 int main(int argc, char* argv[])
 {
+    Benchmark::ParseArgs(argc, argv);
+    if (Benchmark::dispatchBench) {
+        Benchmark::RunDispatchBenchmark();
+        return 0;
+    }
+    if (Benchmark::allocBench) {
+        Benchmark::RunAllocatorBenchmark();
+        return 0;
+    }
     Engine::GameLoop();
 
     return 0;
@@ -0,0 +1,18 @@
+#include "CookedScene.h"
+
+#include <iostream>
+#include <string>
+
+// Cooks every scene and template under a resources directory into <resources>/cooked.
+int main(int argc, char* argv[])
+{
+    if (argc > 2) {
+        std::cout << "usage: scene_cook [resources directory]" << std::endl;
+        return 2;
+    }
+    if (argc == 2) {
+        CookedScene::resourcesDirectory = argv[1];
+    }
+
+    return CookedScene::CookAll() == 0 ? 0 : 1;
+}